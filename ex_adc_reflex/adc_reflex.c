@@ -0,0 +1,460 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_reflex
+ *
+ *          Closed-loop ADC to LED path:
+ *          --------------------------------
+ *          AIN4 (Potentiometer) is sampled at a fixed rate (default 1 kHz)
+ *          and every sample is compared against per LED hysteresis
+ *          thresholds. LEDs whose state changes are written in the same
+ *          processing step, so there is no second timer between the
+ *          measurement and the alarm output.
+ *
+ *          LED n is switched on when the sample rises above on[n] and
+ *          switched off when it falls below off[n] (off[n] < on[n]).
+ *          By default the four LEDs form a bar graph over the input range.
+ *
+ *          The adc and LED value files are opened once and accessed with
+ *          pread/pwrite. The latency from the start of the sample read to
+ *          the completed LED write is measured for every step and printed
+ *          as min/p50/p99/max on exit (Ctrl-C).
+ *
+ *          Usage: adc_reflex [-r rate_hz] [-l on1,on2,on3,on4] [-H hyst]
+ *                            [-p rt_prio]
+ *
+ * \file    adc_reflex.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Resync the deadline after an overrun
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <sched.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* sysfs mount for the ADC and LED files */
+#ifndef SYSFS_ROOT
+#define SYSFS_ROOT		"/sys"
+#endif
+
+/* String to access the ADC4 via sysfs */
+#define AIN4_DEV		SYSFS_ROOT "/bus/iio/devices/iio:device0/in_voltage4_raw"
+
+/* Define some useful constants */
+#define SYSFS_PATH		SYSFS_ROOT "/class/gpio/"
+#define MAX_PATH_STR		512
+#define BUFFER_SIZE		16
+#define ADC_MAX			4095
+#define ONE_SECOND_NS		1000000000L
+#define DEF_RATE_HZ		1000
+#define DEF_HYSTERESIS		40
+
+/* Latency histogram, 1 us buckets */
+#define HIST_BUCKETS		2000
+
+/* Define the GPIO numbers of the BBB-BFH-Cape LEDs */
+#define LED_1			61
+#define LED_2			44
+#define LED_3			68
+#define LED_4			67
+#define MAX_GPIO		(4)
+
+/* The cape LEDs are active low */
+static char ON[]  = "0";
+static char OFF[] = "1";
+
+/* Static variables */
+static int32_t gpio_led[MAX_GPIO] = {LED_1, LED_2, LED_3, LED_4};
+static int     led_fd[MAX_GPIO];
+static int     adc_fd;
+
+/* Hysteresis thresholds in adc counts */
+static int32_t thr_on[MAX_GPIO];
+static int32_t thr_off[MAX_GPIO];
+static bool    led_state[MAX_GPIO];
+
+/* Latency statistics */
+struct latency {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint64_t hist[HIST_BUCKETS + 1];
+};
+
+static struct latency lat_step;		/* Every sample, sample read to LED write */
+static struct latency lat_output;	/* Samples that changed an LED */
+static uint64_t       overruns;
+static volatile sig_atomic_t stop;
+
+/*
+ ***************************************************************************
+ * Time in ns of the given clock
+ ***************************************************************************
+ */
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * ONE_SECOND_NS + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Add one latency value to the statistics
+ ***************************************************************************
+ */
+static void latency_add(struct latency *l, uint64_t ns)
+{
+    uint64_t us = ns / 1000;
+
+    if (l->count == 0 || ns < l->min_ns) {
+        l->min_ns = ns;
+    }
+    if (ns > l->max_ns) {
+        l->max_ns = ns;
+    }
+    l->count++;
+    l->sum_ns += ns;
+    l->hist[us < HIST_BUCKETS ? us : HIST_BUCKETS]++;
+}
+
+/*
+ ***************************************************************************
+ * Percentile in us from the histogram, p in [0, 100]
+ ***************************************************************************
+ */
+static uint64_t latency_percentile(const struct latency *l, double p)
+{
+    uint64_t rank = (uint64_t) (l->count * p / 100.0), seen = 0;
+    int i;
+
+    for (i = 0; i <= HIST_BUCKETS; i++) {
+        seen += l->hist[i];
+        if (seen > rank) {
+            return i;
+        }
+    }
+    return HIST_BUCKETS;
+}
+
+/*
+ ***************************************************************************
+ * Print the latency statistics
+ ***************************************************************************
+ */
+static void latency_print(const char *name, const struct latency *l)
+{
+    if (l->count == 0) {
+        printf("%-8s: no samples\n", name);
+        return;
+    }
+    printf("%-8s: %llu samples, min %.1f us, mean %.1f us, p50 %llu us, "
+           "p99 %llu us, max %.1f us\n", name,
+           (unsigned long long) l->count, l->min_ns / 1000.0,
+           (double) l->sum_ns / l->count / 1000.0,
+           (unsigned long long) latency_percentile(l, 50),
+           (unsigned long long) latency_percentile(l, 99),
+           l->max_ns / 1000.0);
+}
+
+/*
+ ***************************************************************************
+ * Write a string to a sysfs file
+ ***************************************************************************
+ */
+static int sysfs_write(const char *path, const char *val)
+{
+    int fd, ret;
+
+    fd = open(path, O_WRONLY);
+    if (fd < 0) {
+        perror(path);
+        return fd;
+    }
+    ret = write(fd, val, strlen(val));
+    close(fd);
+    return ret < 0 ? ret : 0;
+}
+
+/*
+ ***************************************************************************
+ * Export an LED, make it an output and keep its value file open
+ ***************************************************************************
+ */
+static int led_setup(int i)
+{
+    char path_str[MAX_PATH_STR];
+    char gpio_str[BUFFER_SIZE];
+
+    snprintf(gpio_str, sizeof(gpio_str), "%d", gpio_led[i]);
+    sysfs_write(SYSFS_PATH"export", gpio_str);
+
+    snprintf(path_str, sizeof(path_str), SYSFS_PATH"gpio%d/direction", gpio_led[i]);
+    if (sysfs_write(path_str, "out") < 0) {
+        return -1;
+    }
+
+    snprintf(path_str, sizeof(path_str), SYSFS_PATH"gpio%d/value", gpio_led[i]);
+    led_fd[i] = open(path_str, O_WRONLY);
+    if (led_fd[i] < 0) {
+        perror(path_str);
+        return -1;
+    }
+    return pwrite(led_fd[i], OFF, 1, 0) == 1 ? 0 : -1;
+}
+
+/*
+ ***************************************************************************
+ * Switch the LEDs off and unexport them
+ ***************************************************************************
+ */
+static void led_cleanup(void)
+{
+    char gpio_str[BUFFER_SIZE];
+    int i;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        if (led_fd[i] >= 0) {
+            pwrite(led_fd[i], OFF, 1, 0);
+            close(led_fd[i]);
+        }
+        snprintf(gpio_str, sizeof(gpio_str), "%d", gpio_led[i]);
+        sysfs_write(SYSFS_PATH"unexport", gpio_str);
+    }
+}
+
+/*
+ ***************************************************************************
+ * Read the raw adc value, -1 on errors
+ ***************************************************************************
+ */
+static inline int32_t adc_read(void)
+{
+    char buf[BUFFER_SIZE];
+    ssize_t n;
+
+    n = pread(adc_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return -1;
+    }
+    buf[n] = '\0';
+    return atoi(buf);
+}
+
+/*
+ ***************************************************************************
+ * Evaluate one sample against the hysteresis thresholds and drive the
+ * LEDs that change. Returns the number of LEDs written.
+ ***************************************************************************
+ */
+static inline int reflex_step(int32_t raw)
+{
+    int i, changed = 0;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        if (!led_state[i] && raw > thr_on[i]) {
+            led_state[i] = true;
+        } else if (led_state[i] && raw < thr_off[i]) {
+            led_state[i] = false;
+        } else {
+            continue;
+        }
+        pwrite(led_fd[i], led_state[i] ? ON : OFF, 1, 0);
+        changed++;
+    }
+    return changed;
+}
+
+/*
+ ***************************************************************************
+ * Parse "on1,on2,on3,on4" and derive the off thresholds
+ ***************************************************************************
+ */
+static int parse_levels(const char *arg, int32_t hyst)
+{
+    char *end;
+    int i;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        thr_on[i] = strtol(arg, &end, 0);
+        if (end == arg || (i < MAX_GPIO - 1 && *end != ',')) {
+            return -1;
+        }
+        arg = end + 1;
+    }
+    for (i = 0; i < MAX_GPIO; i++) {
+        thr_off[i] = thr_on[i] - hyst;
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Define the function to be called when ctrl-c (SIGINT) or SIGTERM is
+ * sent to the process
+ ***************************************************************************
+ */
+static void signal_stop_handler(int sig_num)
+{
+    stop = 1;
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    struct sched_param sp;
+    struct timespec next;
+    const char *levels = NULL;
+    uint64_t period_ns, t0, t1;
+    int32_t  hyst = DEF_HYSTERESIS, raw;
+    int      rate = DEF_RATE_HZ, prio = 0, opt, i;
+
+    while ((opt = getopt(argc, argv, "r:l:H:p:")) != -1) {
+        switch (opt) {
+        case 'r':
+            rate = atoi(optarg);
+            break;
+        case 'l':
+            levels = optarg;
+            break;
+        case 'H':
+            hyst = atoi(optarg);
+            break;
+        case 'p':
+            prio = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-r rate_hz] [-l on1,on2,on3,on4] [-H hyst] [-p rt_prio]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (rate <= 0) {
+        fprintf(stderr, "Invalid rate\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Thresholds, default is a bar graph over the input range */
+    if (levels != NULL) {
+        if (parse_levels(levels, hyst) < 0) {
+            fprintf(stderr, "Invalid levels: %s\n", levels);
+            return EXIT_FAILURE;
+        }
+    } else {
+        for (i = 0; i < MAX_GPIO; i++) {
+            thr_on[i]  = (i + 1) * ADC_MAX / (MAX_GPIO + 1) + hyst / 2;
+            thr_off[i] = thr_on[i] - hyst;
+        }
+    }
+
+    /* Register signal handlers */
+    signal(SIGINT, signal_stop_handler);
+    signal(SIGTERM, signal_stop_handler);
+
+    /* Open the adc once, it is read with pread afterwards */
+    adc_fd = open(AIN4_DEV, O_RDONLY);
+    if (adc_fd < 0) {
+        perror(AIN4_DEV);
+        return EXIT_FAILURE;
+    }
+
+    /* Setup the LEDs */
+    for (i = 0; i < MAX_GPIO; i++) {
+        led_fd[i] = -1;
+    }
+    for (i = 0; i < MAX_GPIO; i++) {
+        if (led_setup(i) < 0) {
+            led_cleanup();
+            close(adc_fd);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Optional real-time priority, no page faults in the loop */
+    if (prio > 0) {
+        sp.sched_priority = prio;
+        if (sched_setscheduler(0, SCHED_FIFO, &sp) < 0) {
+            perror("sched_setscheduler");
+        }
+    }
+    mlockall(MCL_CURRENT | MCL_FUTURE);
+
+    /* Periodic loop on absolute deadlines */
+    period_ns = ONE_SECOND_NS / rate;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!stop) {
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= ONE_SECOND_NS) {
+            next.tv_nsec -= ONE_SECOND_NS;
+            next.tv_sec++;
+        }
+
+        /* After an overrun skip the missed deadlines instead of catching up back-to-back */
+        if (now_ns() > (uint64_t) next.tv_sec * ONE_SECOND_NS + next.tv_nsec) {
+            clock_gettime(CLOCK_MONOTONIC, &next);
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        t0 = now_ns();
+        raw = adc_read();
+        if (raw < 0) {
+            continue;
+        }
+        i = reflex_step(raw);
+        t1 = now_ns();
+
+        latency_add(&lat_step, t1 - t0);
+        if (i > 0) {
+            latency_add(&lat_output, t1 - t0);
+        }
+        if (t1 > (uint64_t) next.tv_sec * ONE_SECOND_NS + next.tv_nsec + period_ns) {
+            overruns++;
+        }
+    }
+
+    /* Report and clean up */
+    printf("\nExit, %d Hz, %llu overruns\n", rate, (unsigned long long) overruns);
+    latency_print("step", &lat_step);
+    latency_print("output", &lat_output);
+
+    led_cleanup();
+    close(adc_fd);
+    return EXIT_SUCCESS;
+}
@@ -54,8 +54,13 @@
 #define ONE_MILLISECOND		1000
 #define ONE_SECOND		1000000
 
+/* Where sysfs is mounted */
+#ifndef SYSFS_ROOT
+#define SYSFS_ROOT		"/sys"
+#endif
+
 /* Define some useful constants */
-#define SYSFS_PATH		"/sys/class/gpio/"
+#define SYSFS_PATH		SYSFS_ROOT "/class/gpio/"
 #define MAX_STR_BUF		512
 #define MAX_PATH_STR	512
 #define LOW		    	0
@@ -0,0 +1,549 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux btn_latency
+ *
+ *          End-to-end latency from a button edge to the matching LED
+ *          write of a program that maps the buttons onto the LEDs, such
+ *          as button_led_map or examlib -b.
+ *
+ *          The program runs against a stand-in GPIO tree, it has to be
+ *          built with the same root:
+ *
+ *          make -C ../ex_button_led_mapping HOST=1 SYSFS_ROOT=/dev/shm/bl clean all
+ *          btn_latency -d /dev/shm/bl -m poll -- ../ex_button_led_mapping/button_led_map
+ *
+ *          make -C ../examlib HOST=1 SYSFS_ROOT=/dev/shm/bl clean all
+ *          btn_latency -d /dev/shm/bl -m timer -i 700 -- ../examlib/examlib -b
+ *
+ *          Without a simulator the tree is made of regular files (tmpfs
+ *          recommended) and the button value files are written directly.
+ *          If the root is a gpio_sim mount (it has sim/inject), the
+ *          buttons are driven through sim/inject instead.
+ *
+ *          The buttons T1..T4 are pressed and released in turn, one edge
+ *          every interval plus a random 0..interval/2 ms, so the edges do
+ *          not lock onto the polling period of the program. After each
+ *          edge the LED value files are watched with inotify until the LED
+ *          shows the expected value (pressed = on). The latency runs from
+ *          the completed button write to the inotify wake-up and includes
+ *          the wake-up of the harness.
+ *
+ *          Reported as one JSON line per run on stdout: p50, p99, max and
+ *          mean latency in us, missed edges (no response within the
+ *          timeout), and the CPU time of the program from /proc/<pid>/stat
+ *          over the measurement, also in % of one CPU. A summary goes to
+ *          stderr.
+ *
+ *          Usage: btn_latency -d root [-m mode] [-n edges] [-i interval_ms]
+ *                             [-t timeout_ms] [-w warmup_ms] [-v]
+ *                             -- program [args]
+ *
+ * \file    btn_latency.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/* Define some useful constants */
+#define MAX_PATH_STR		512
+#define MAX_STR_BUF		64
+#define DEF_EDGES		200
+#define MAX_EDGES		100000
+#define DEF_INTERVAL_MS		100
+#define DEF_TIMEOUT_MS		2000
+#define DEF_WARMUP_MS		1500
+#define ONE_MS_NS		1000000ULL
+#define PRESSED			'0'
+#define LED_ON			'0'
+#define LED_OFF			'1'
+
+/* Define the GPIO numbers of the BBB-BFH-Cape LEDs */
+#define LED_1			61
+#define LED_2			44
+#define LED_3			68
+#define LED_4			67
+
+/* Define the assignment button to pin number of the BBB-BFH-Cape */
+#define BUTN_1			49
+#define BUTN_2			112
+#define BUTN_3			51
+#define BUTN_4			7
+#define MAX_GPIO		(4)
+
+/* Static variables */
+static int32_t     gpio_led[MAX_GPIO] = {LED_1, LED_2, LED_3, LED_4};
+static int32_t     gpio_btn[MAX_GPIO] = {BUTN_1, BUTN_2, BUTN_3, BUTN_4};
+static const char *root;
+
+static int led_fd[MAX_GPIO], led_wd[MAX_GPIO], btn_fd[MAX_GPIO];
+static int inject_fd = -1, inotify_fd = -1;
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns
+ ***************************************************************************
+ */
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t t)
+{
+    struct timespec ts = { .tv_sec = t / 1000000000ULL, .tv_nsec = t % 1000000000ULL };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        ;
+    }
+}
+
+/*
+ ***************************************************************************
+ * Stand-in tree of regular files
+ ***************************************************************************
+ */
+static int make_dir(const char *path)
+{
+    char buf[MAX_PATH_STR], *p;
+
+    snprintf(buf, sizeof(buf), "%s", path);
+    for (p = buf + 1; ; p++) {
+        if (*p == '/' || *p == '\0') {
+            char c = *p;
+
+            *p = '\0';
+            if (mkdir(buf, 0755) < 0 && errno != EEXIST) {
+                perror(buf);
+                return -1;
+            }
+            if ((*p = c) == '\0') {
+                return 0;
+            }
+        }
+    }
+}
+
+static int write_file(const char *path, const char *text)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fputs(text, f);
+    return fclose(f);
+}
+
+static int make_line(int32_t gpio, const char *dir, const char *value)
+{
+    char path[MAX_PATH_STR];
+
+    snprintf(path, sizeof(path), "%s/class/gpio/gpio%d", root, gpio);
+    if (make_dir(path) < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/class/gpio/gpio%d/direction", root, gpio);
+    if (write_file(path, dir) < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/class/gpio/gpio%d/value", root, gpio);
+    return write_file(path, value);
+}
+
+static int make_tree(void)
+{
+    char path[MAX_PATH_STR];
+    int i;
+
+    snprintf(path, sizeof(path), "%s/bus/iio/devices/iio:device0", root);
+    if (make_dir(path) < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/bus/iio/devices/iio:device0/in_voltage4_raw", root);
+    if (write_file(path, "2048\n") < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/class/gpio", root);
+    if (make_dir(path) < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/class/gpio/export", root);
+    if (write_file(path, "") < 0) {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/class/gpio/unexport", root);
+    if (write_file(path, "") < 0) {
+        return -1;
+    }
+    for (i = 0; i < MAX_GPIO; i++) {
+        if (make_line(gpio_led[i], "out\n", "1\n") < 0 ||
+            make_line(gpio_btn[i], "in\n", "1\n") < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Open the LED and button files, watch the LEDs
+ ***************************************************************************
+ */
+static int open_lines(void)
+{
+    char path[MAX_PATH_STR];
+    int i;
+
+    if ((inotify_fd = inotify_init1(IN_NONBLOCK)) < 0) {
+        perror("inotify_init1");
+        return -1;
+    }
+    for (i = 0; i < MAX_GPIO; i++) {
+        snprintf(path, sizeof(path), "%s/class/gpio/gpio%d/value", root, gpio_led[i]);
+        if ((led_fd[i] = open(path, O_RDONLY)) < 0 ||
+            (led_wd[i] = inotify_add_watch(inotify_fd, path, IN_MODIFY)) < 0) {
+            perror(path);
+            return -1;
+        }
+        if (inject_fd >= 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/class/gpio/gpio%d/value", root, gpio_btn[i]);
+        if ((btn_fd[i] = open(path, O_WRONLY)) < 0) {
+            perror(path);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Set a button, pressed = low */
+static int drive_button(int i, int pressed)
+{
+    char msg[MAX_STR_BUF];
+    int len;
+
+    if (inject_fd >= 0) {
+        len = snprintf(msg, sizeof(msg), "gpio%d %d\n", gpio_btn[i], pressed ? 0 : 1);
+        return pwrite(inject_fd, msg, len, 0) == len ? 0 : -1;
+    }
+    return pwrite(btn_fd[i], pressed ? "0\n" : "1\n", 2, 0) == 2 ? 0 : -1;
+}
+
+static int led_value(int i)
+{
+    char c;
+
+    return pread(led_fd[i], &c, 1, 0) == 1 ? c : -1;
+}
+
+/* Drop the events of writes that happened before the edge */
+static void drain_events(void)
+{
+    char buf[4096];
+
+    while (read(inotify_fd, buf, sizeof(buf)) > 0) {
+        ;
+    }
+}
+
+/*
+ ***************************************************************************
+ * Wait until LED i shows the value expect, 0 on timeout
+ ***************************************************************************
+ */
+static uint64_t wait_led(int i, char expect, uint64_t deadline)
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event *ev;
+    struct pollfd pfd = { .fd = inotify_fd, .events = POLLIN };
+    uint64_t now;
+    ssize_t len, off;
+    int seen;
+
+    while ((now = now_ns()) < deadline) {
+        if (poll(&pfd, 1, (deadline - now) / ONE_MS_NS + 1) <= 0) {
+            continue;
+        }
+        seen = 0;
+        while ((len = read(inotify_fd, buf, sizeof(buf))) > 0) {
+            for (off = 0; off < len; off += sizeof(*ev) + ev->len) {
+                ev = (const struct inotify_event *) (buf + off);
+                seen |= (ev->wd == led_wd[i]);
+            }
+        }
+        now = now_ns();
+        if (seen && led_value(i) == expect) {
+            return now;
+        }
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * CPU time of a process in ms, from /proc/<pid>/stat
+ ***************************************************************************
+ */
+static int64_t proc_cpu_ms(pid_t pid)
+{
+    char path[MAX_STR_BUF], buf[1024], *p;
+    unsigned long long utime, stime;
+    ssize_t len;
+    int fd;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int) pid);
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return -1;
+    }
+    len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+
+    /* The command name may hold spaces, the fields start after the last ')' */
+    if ((p = strrchr(buf, ')')) == NULL ||
+        sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+               &utime, &stime) != 2) {
+        return -1;
+    }
+    return (int64_t) (utime + stime) * 1000 / sysconf(_SC_CLK_TCK);
+}
+
+static int64_t self_cpu_ms(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000LL +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000;
+}
+
+/*
+ ***************************************************************************
+ * Start and stop the program under test
+ ***************************************************************************
+ */
+static pid_t start_program(char *argv[], int verbose)
+{
+    pid_t pid = fork();
+    int fd;
+
+    if (pid == 0) {
+        if (!verbose && (fd = open("/dev/null", O_WRONLY)) >= 0) {
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+        execvp(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    return pid;
+}
+
+static void stop_program(pid_t pid)
+{
+    int i;
+
+    kill(pid, SIGTERM);
+    for (i = 0; i < 200; i++) {
+        if (waitpid(pid, NULL, WNOHANG) == pid) {
+            return;
+        }
+        usleep(10000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s -d root [-m mode] [-n edges] [-i interval_ms]\n"
+            "                   [-t timeout_ms] [-w warmup_ms] [-v] -- program [args]\n", prog);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    uint32_t edges = DEF_EDGES, interval_ms = DEF_INTERVAL_MS;
+    uint32_t timeout_ms = DEF_TIMEOUT_MS, warmup_ms = DEF_WARMUP_MS;
+    uint64_t *lat, sum = 0, t_start, t_end, t_next, t_edge, t_led;
+    int64_t cpu0, cpu1, self0, self1;
+    const char *mode = "default", *prog;
+    char path[MAX_PATH_STR], expect;
+    unsigned seed = 1;
+    uint32_t k, n = 0, missed = 0;
+    int opt, verbose = 0, b, pressed, status;
+    pid_t pid;
+
+    while ((opt = getopt(argc, argv, "d:m:n:i:t:w:v")) != -1) {
+        switch (opt) {
+        case 'd':
+            root = optarg;
+            break;
+        case 'm':
+            mode = optarg;
+            break;
+        case 'n':
+            edges = atoi(optarg);
+            break;
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        case 't':
+            timeout_ms = atoi(optarg);
+            break;
+        case 'w':
+            warmup_ms = atoi(optarg);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (root == NULL || optind >= argc || edges == 0 || edges > MAX_EDGES ||
+        interval_ms == 0 || timeout_ms == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((prog = strrchr(argv[optind], '/')) != NULL) {
+        prog++;
+    } else {
+        prog = argv[optind];
+    }
+    if ((lat = malloc(edges * sizeof(*lat))) == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    /* A gpio_sim mount or a tree of regular files */
+    snprintf(path, sizeof(path), "%s/sim/inject", root);
+    if ((inject_fd = open(path, O_WRONLY)) < 0 && make_tree() < 0) {
+        return EXIT_FAILURE;
+    }
+
+    if ((pid = start_program(&argv[optind], verbose)) < 0) {
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+    sleep_until(now_ns() + warmup_ms * ONE_MS_NS);
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+        fprintf(stderr, "%s exited during the warm-up\n", prog);
+        return EXIT_FAILURE;
+    }
+    if (open_lines() < 0) {
+        stop_program(pid);
+        return EXIT_FAILURE;
+    }
+
+    cpu0    = proc_cpu_ms(pid);
+    self0   = self_cpu_ms();
+    t_start = now_ns();
+    t_next  = t_start;
+    for (k = 0; k < edges; k++) {
+        b       = (k / 2) % MAX_GPIO;
+        pressed = !(k & 1);
+        expect  = pressed ? LED_ON : LED_OFF;
+
+        t_next += (interval_ms + rand_r(&seed) % (interval_ms / 2 + 1)) * ONE_MS_NS;
+        sleep_until(t_next);
+
+        /* A missed edge before may leave the LED in the expected state */
+        if (led_value(b) == expect) {
+            drive_button(b, pressed);
+            missed++;
+            continue;
+        }
+        drain_events();
+        if (drive_button(b, pressed) < 0) {
+            perror("button write");
+            break;
+        }
+        t_edge = now_ns();
+        t_led  = wait_led(b, expect, t_edge + timeout_ms * ONE_MS_NS);
+        if (t_led == 0) {
+            missed++;
+        } else {
+            lat[n] = (t_led - t_edge) / 1000;
+            sum   += lat[n++];
+        }
+        if (now_ns() > t_next) {
+            t_next = now_ns();
+        }
+    }
+    t_end = now_ns();
+    cpu1  = proc_cpu_ms(pid);
+    self1 = self_cpu_ms();
+    stop_program(pid);
+
+    qsort(lat, n, sizeof(lat[0]), cmp_u64);
+    printf("{\"program\": \"%s\", \"mode\": \"%s\", \"edges\": %u, \"measured\": %u, "
+           "\"missed\": %u, \"p50_us\": %llu, \"p99_us\": %llu, \"max_us\": %llu, "
+           "\"mean_us\": %llu, \"cpu_ms\": %lld, \"cpu_pct\": %.1f, \"harness_cpu_pct\": %.1f}\n",
+           prog, mode, k, n, missed,
+           (unsigned long long) (n ? lat[(n - 1) * 50 / 100] : 0),
+           (unsigned long long) (n ? lat[(n - 1) * 99 / 100] : 0),
+           (unsigned long long) (n ? lat[n - 1] : 0),
+           (unsigned long long) (n ? sum / n : 0),
+           (long long) (cpu1 - cpu0),
+           (cpu1 - cpu0) * 1e8 / (t_end - t_start),
+           (self1 - self0) * 1e8 / (t_end - t_start));
+    fprintf(stderr, "%s %s: %u edges, %u missed, p50 %llu us, p99 %llu us, max %llu us, cpu %.1f %%\n",
+            prog, mode, k, missed,
+            (unsigned long long) (n ? lat[(n - 1) * 50 / 100] : 0),
+            (unsigned long long) (n ? lat[(n - 1) * 99 / 100] : 0),
+            (unsigned long long) (n ? lat[n - 1] : 0),
+            (cpu1 - cpu0) * 1e8 / (t_end - t_start));
+    free(lat);
+    return missed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,641 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux gpio_bench
+ *
+ *          Microbenchmark of the ways to access the sysfs GPIO interface.
+ *          Backends:
+ *
+ *          sysfs   path built, open, read/write, close on every call, as
+ *                  sysfs_gpio_handler() in examlib and the other examples
+ *          cached  the value, export and unexport files are opened once
+ *                  and accessed with pread/pwrite
+ *          batch   cached, plus a shadow of the line values: a four-line
+ *                  set writes only the lines that change. sysfs has no
+ *                  call that covers several value files, so a four-line
+ *                  get is the same as with cached.
+ *
+ *          Operations, each measured per backend:
+ *
+ *          get1            read line 0
+ *          set1            toggle line 0
+ *          get4            read the four lines
+ *          set4            next step of a moving light on the four lines
+ *                          (one line goes on, one goes off)
+ *          export_unexport export and unexport the line given with -e
+ *
+ *          Every operation runs rounds x iterations times after a warm-up.
+ *          The median and the minimum ns/op over the rounds, ops/s and the
+ *          syscalls per op are written as JSON, in a fixed order with
+ *          integer values, so results of two builds can be compared by a
+ *          script. The exit code is 1 if an operation failed.
+ *
+ *          The root defaults to /sys/class/gpio. Lines not yet exported
+ *          are exported and set to output, and unexported at the end. On a
+ *          host, -f creates a fake tree of regular files under the root,
+ *          e.g. on tmpfs:
+ *
+ *          gpio_bench -f -d /dev/shm/gpio -e 26 > host.json
+ *
+ *          Usage: gpio_bench [-d root] [-f] [-e gpio] [-n iterations]
+ *                            [-r rounds] [-c cpu] [-o jsonfile]
+ *
+ * \file    gpio_bench.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+/* sysfs root, benchmarks the simulator when built with SYSFS_ROOT */
+#ifndef SYSFS_ROOT
+#define SYSFS_ROOT		"/sys"
+#endif
+
+/* Define some useful constants */
+#define SYSFS_PATH		SYSFS_ROOT "/class/gpio"
+#define MAX_PATH_STR		512
+#define MAX_STR_BUF		16
+#define DEF_ITERATIONS		2000
+#define DEF_ROUNDS		7
+#define MAX_ROUNDS		64
+#define JSON_FORMAT		1
+
+/* Define the GPIO numbers of the BBB-BFH-Cape LEDs */
+#define LED_1			61
+#define LED_2			44
+#define LED_3			68
+#define LED_4			67
+#define MAX_GPIO		(4)
+
+/* The cape LEDs are active low */
+static char ON[]  = "0";
+static char OFF[] = "1";
+static char OUT[] = "out";
+
+/* Static variables */
+static int32_t     gpio_led[MAX_GPIO] = {LED_1, LED_2, LED_3, LED_4};
+static const char *root = SYSFS_PATH;
+static int32_t     export_gpio = -1;
+static int         exported[MAX_GPIO];
+
+/* Open files of the cached and batch backends */
+static int  value_fd[MAX_GPIO] = {-1, -1, -1, -1};
+static int  export_fd = -1, unexport_fd = -1;
+static char shadow[MAX_GPIO];
+
+/* Syscalls done by the backends */
+static uint64_t syscalls;
+
+/* A way to access the GPIOs */
+struct backend {
+    const char *name;
+    int  (*get)(unsigned line, char *val);
+    int  (*set)(unsigned line, const char *val);
+    int  (*get4)(char val[MAX_GPIO]);
+    int  (*set4)(unsigned on_line);
+    int  (*export_unexport)(int32_t gpio);
+};
+
+/* Operations */
+enum {
+    OP_GET1 = 0,
+    OP_SET1,
+    OP_GET4,
+    OP_SET4,
+    OP_EXPORT_UNEXPORT,
+    OP_COUNT
+};
+
+static const char *op_name[OP_COUNT] = {
+    "get1", "set1", "get4", "set4", "export_unexport"
+};
+
+/* Result of one operation on one backend */
+struct result {
+    const char *backend;
+    const char *op;
+    uint64_t    median_ns;
+    uint64_t    min_ns;
+    uint64_t    syscalls;	/* Per op, times 100 */
+    uint64_t    errors;
+};
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns
+ ***************************************************************************
+ */
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Path of a file below the root, gpio < 0 for the top level files
+ ***************************************************************************
+ */
+static void gpio_path(char *buf, size_t size, int32_t gpio, const char *file)
+{
+    if (gpio < 0) {
+        snprintf(buf, size, "%s/%s", root, file);
+    } else {
+        snprintf(buf, size, "%s/gpio%d/%s", root, gpio, file);
+    }
+}
+
+/*
+ ***************************************************************************
+ * sysfs backend: one open, read or write and close per call
+ ***************************************************************************
+ */
+static int sysfs_access(int32_t gpio, const char *file, int oflags, char *buf, size_t len)
+{
+    char    path_str[MAX_PATH_STR];
+    ssize_t n;
+    int     fd;
+
+    gpio_path(path_str, sizeof(path_str), gpio, file);
+    syscalls++;
+    if ((fd = open(path_str, oflags)) < 0) {
+        return -1;
+    }
+    syscalls += 2;
+    n = (oflags == O_RDONLY) ? read(fd, buf, len) : write(fd, buf, len);
+    close(fd);
+    return n > 0 ? 0 : -1;
+}
+
+static int sysfs_get(unsigned line, char *val)
+{
+    return sysfs_access(gpio_led[line], "value", O_RDONLY, val, 1);
+}
+
+static int sysfs_set(unsigned line, const char *val)
+{
+    return sysfs_access(gpio_led[line], "value", O_WRONLY, (char *) val, strlen(val) + 1);
+}
+
+static int sysfs_get4(char val[MAX_GPIO])
+{
+    int i, ret = 0;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        ret |= sysfs_get(i, &val[i]);
+    }
+    return ret;
+}
+
+static int sysfs_set4(unsigned on_line)
+{
+    int i, ret = 0;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        ret |= sysfs_set(i, i == on_line ? ON : OFF);
+    }
+    return ret;
+}
+
+static int sysfs_export_unexport(int32_t gpio)
+{
+    char strBuf[MAX_STR_BUF];
+    int  len = snprintf(strBuf, sizeof(strBuf), "%d", gpio);
+
+    if (sysfs_access(-1, "export", O_WRONLY, strBuf, len) < 0) {
+        return -1;
+    }
+    return sysfs_access(-1, "unexport", O_WRONLY, strBuf, len);
+}
+
+/*
+ ***************************************************************************
+ * cached backend: files opened once, pread/pwrite at offset 0
+ ***************************************************************************
+ */
+static int cached_get(unsigned line, char *val)
+{
+    syscalls++;
+    return pread(value_fd[line], val, 1, 0) == 1 ? 0 : -1;
+}
+
+static int cached_set(unsigned line, const char *val)
+{
+    syscalls++;
+    return pwrite(value_fd[line], val, 1, 0) == 1 ? 0 : -1;
+}
+
+static int cached_get4(char val[MAX_GPIO])
+{
+    int i, ret = 0;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        ret |= cached_get(i, &val[i]);
+    }
+    return ret;
+}
+
+static int cached_set4(unsigned on_line)
+{
+    int i, ret = 0;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        ret |= cached_set(i, i == on_line ? ON : OFF);
+    }
+    return ret;
+}
+
+static int cached_export_unexport(int32_t gpio)
+{
+    char strBuf[MAX_STR_BUF];
+    int  len = snprintf(strBuf, sizeof(strBuf), "%d", gpio);
+
+    syscalls += 2;
+    if (pwrite(export_fd, strBuf, len, 0) != len) {
+        return -1;
+    }
+    return pwrite(unexport_fd, strBuf, len, 0) == len ? 0 : -1;
+}
+
+/*
+ ***************************************************************************
+ * batch backend: cached, writes only lines whose value changes
+ ***************************************************************************
+ */
+static int batch_set(unsigned line, const char *val)
+{
+    if (shadow[line] == val[0]) {
+        return 0;
+    }
+    if (cached_set(line, val) < 0) {
+        shadow[line] = 0;
+        return -1;
+    }
+    shadow[line] = val[0];
+    return 0;
+}
+
+static int batch_set4(unsigned on_line)
+{
+    int i, ret = 0;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        ret |= batch_set(i, i == on_line ? ON : OFF);
+    }
+    return ret;
+}
+
+static const struct backend backends[] = {
+    { "sysfs",  sysfs_get,  sysfs_set,  sysfs_get4,  sysfs_set4,  sysfs_export_unexport },
+    { "cached", cached_get, cached_set, cached_get4, cached_set4, cached_export_unexport },
+    { "batch",  cached_get, batch_set,  cached_get4, batch_set4,  cached_export_unexport },
+};
+
+/*
+ ***************************************************************************
+ * Step i of an operation, consecutive steps change the lines
+ ***************************************************************************
+ */
+static int run_op(const struct backend *b, int op, uint32_t i)
+{
+    char val[MAX_GPIO];
+
+    switch (op) {
+    case OP_GET1:
+        return b->get(0, val);
+    case OP_SET1:
+        return b->set(0, (i & 1) ? ON : OFF);
+    case OP_GET4:
+        return b->get4(val);
+    case OP_SET4:
+        return b->set4(i % MAX_GPIO);
+    case OP_EXPORT_UNEXPORT:
+        return b->export_unexport(export_gpio);
+    }
+    return -1;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+/*
+ ***************************************************************************
+ * Measure one operation, median and minimum ns/op over the rounds
+ ***************************************************************************
+ */
+static void measure(const struct backend *b, int op, uint32_t iterations, int rounds,
+                    struct result *res)
+{
+    uint64_t ns[MAX_ROUNDS], t0, calls;
+    uint32_t i, step = 0;
+    int r;
+
+    memset(res, 0, sizeof(*res));
+    res->backend = b->name;
+    res->op      = op_name[op];
+
+    /* Warm-up, also brings the batch shadow in line with the files. The
+       step runs on over the rounds, so every set4 step changes two lines */
+    for (i = 0; i < iterations / 10 + 1; i++) {
+        run_op(b, op, step++);
+    }
+
+    calls = syscalls;
+    for (r = 0; r < rounds; r++) {
+        t0 = now_ns();
+        for (i = 0; i < iterations; i++) {
+            if (run_op(b, op, step++) < 0) {
+                res->errors++;
+            }
+        }
+        ns[r] = (now_ns() - t0) / iterations;
+    }
+    res->syscalls = (syscalls - calls) * 100 / ((uint64_t) iterations * rounds);
+
+    qsort(ns, rounds, sizeof(ns[0]), cmp_u64);
+    res->median_ns = ns[rounds / 2];
+    res->min_ns    = ns[0];
+}
+
+/*
+ ***************************************************************************
+ * Create a fake sysfs tree of regular files
+ ***************************************************************************
+ */
+static int write_file(const char *path, const char *text)
+{
+    FILE *f = fopen(path, "w");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    fputs(text, f);
+    return fclose(f);
+}
+
+static int make_fake_tree(void)
+{
+    char path[MAX_PATH_STR];
+    int i;
+
+    if (mkdir(root, 0755) < 0 && errno != EEXIST) {
+        perror(root);
+        return -1;
+    }
+    gpio_path(path, sizeof(path), -1, "export");
+    if (write_file(path, "") < 0) {
+        return -1;
+    }
+    gpio_path(path, sizeof(path), -1, "unexport");
+    if (write_file(path, "") < 0) {
+        return -1;
+    }
+    for (i = 0; i < MAX_GPIO; i++) {
+        snprintf(path, sizeof(path), "%s/gpio%d", root, gpio_led[i]);
+        if (mkdir(path, 0755) < 0 && errno != EEXIST) {
+            perror(path);
+            return -1;
+        }
+        gpio_path(path, sizeof(path), gpio_led[i], "direction");
+        if (write_file(path, "out\n") < 0) {
+            return -1;
+        }
+        gpio_path(path, sizeof(path), gpio_led[i], "value");
+        if (write_file(path, "1\n") < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Export the LED lines that are not yet exported, open the cached files
+ ***************************************************************************
+ */
+static int setup(void)
+{
+    char path[MAX_PATH_STR], strBuf[MAX_STR_BUF];
+    int i, len;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        snprintf(path, sizeof(path), "%s/gpio%d", root, gpio_led[i]);
+        if (access(path, F_OK) == 0) {
+            continue;
+        }
+        len = snprintf(strBuf, sizeof(strBuf), "%d", gpio_led[i]);
+        if (sysfs_access(-1, "export", O_WRONLY, strBuf, len) < 0 ||
+            sysfs_access(gpio_led[i], "direction", O_WRONLY, OUT, strlen(OUT) + 1) < 0) {
+            fprintf(stderr, "Can not export gpio%d below %s\n", gpio_led[i], root);
+            return -1;
+        }
+        exported[i] = 1;
+    }
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        gpio_path(path, sizeof(path), gpio_led[i], "value");
+        if ((value_fd[i] = open(path, O_RDWR)) < 0) {
+            perror(path);
+            return -1;
+        }
+    }
+    gpio_path(path, sizeof(path), -1, "export");
+    export_fd = open(path, O_WRONLY);
+    gpio_path(path, sizeof(path), -1, "unexport");
+    unexport_fd = open(path, O_WRONLY);
+    if (export_gpio >= 0 && (export_fd < 0 || unexport_fd < 0)) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+static void cleanup(void)
+{
+    char strBuf[MAX_STR_BUF];
+    int i, len;
+
+    for (i = 0; i < MAX_GPIO; i++) {
+        if (value_fd[i] >= 0) {
+            close(value_fd[i]);
+        }
+        if (exported[i]) {
+            len = snprintf(strBuf, sizeof(strBuf), "%d", gpio_led[i]);
+            sysfs_access(-1, "unexport", O_WRONLY, strBuf, len);
+        }
+    }
+    if (export_fd >= 0) {
+        close(export_fd);
+    }
+    if (unexport_fd >= 0) {
+        close(unexport_fd);
+    }
+}
+
+/*
+ ***************************************************************************
+ * JSON output
+ ***************************************************************************
+ */
+static void json_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf(out, "\\%c", *s);
+        } else if ((unsigned char) *s < 0x20) {
+            fprintf(out, "\\u%04x", *s);
+        } else {
+            fputc(*s, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void write_json(FILE *out, const struct result *res, int count,
+                       uint32_t iterations, int rounds)
+{
+    int i;
+
+    fprintf(out, "{\n  \"benchmark\": \"gpio_bench\",\n  \"format\": %d,\n  \"root\": ", JSON_FORMAT);
+    json_string(out, root);
+    fprintf(out, ",\n  \"lines\": [%d, %d, %d, %d],\n  \"export_line\": %d,\n",
+            gpio_led[0], gpio_led[1], gpio_led[2], gpio_led[3], export_gpio);
+    fprintf(out, "  \"iterations\": %u,\n  \"rounds\": %d,\n  \"results\": [", iterations, rounds);
+    for (i = 0; i < count; i++) {
+        fprintf(out, "%s\n    {\"backend\": \"%s\", \"op\": \"%s\", \"ns_per_op\": %llu, "
+                "\"ns_per_op_min\": %llu, \"ops_per_s\": %llu, \"syscalls_per_op\": %llu.%02llu, "
+                "\"errors\": %llu}",
+                i ? "," : "", res[i].backend, res[i].op,
+                (unsigned long long) res[i].median_ns,
+                (unsigned long long) res[i].min_ns,
+                (unsigned long long) (res[i].median_ns ? 1000000000ULL / res[i].median_ns : 0),
+                (unsigned long long) res[i].syscalls / 100,
+                (unsigned long long) res[i].syscalls % 100,
+                (unsigned long long) res[i].errors);
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    struct result res[sizeof(backends) / sizeof(backends[0]) * OP_COUNT];
+    uint32_t iterations = DEF_ITERATIONS;
+    int rounds = DEF_ROUNDS, fake = 0, cpu = -1, count = 0, opt, op, ret = EXIT_SUCCESS;
+    const char *json = NULL;
+    cpu_set_t set;
+    unsigned b;
+    FILE *out = stdout;
+
+    while ((opt = getopt(argc, argv, "d:fe:n:r:c:o:")) != -1) {
+        switch (opt) {
+        case 'd':
+            root = optarg;
+            break;
+        case 'f':
+            fake = 1;
+            break;
+        case 'e':
+            export_gpio = atoi(optarg);
+            break;
+        case 'n':
+            iterations = atoi(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 'c':
+            cpu = atoi(optarg);
+            break;
+        case 'o':
+            json = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d root] [-f] [-e gpio] [-n iterations]\n"
+                    "                  [-r rounds] [-c cpu] [-o jsonfile]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (iterations == 0 || rounds <= 0 || rounds > MAX_ROUNDS) {
+        fprintf(stderr, "Invalid arguments\n");
+        return EXIT_FAILURE;
+    }
+
+    /* One cpu gives steadier numbers */
+    if (cpu >= 0) {
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+            perror("sched_setaffinity");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((fake && make_fake_tree() < 0) || setup() < 0) {
+        cleanup();
+        return EXIT_FAILURE;
+    }
+
+    for (b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        for (op = 0; op < OP_COUNT; op++) {
+            if (op == OP_EXPORT_UNEXPORT && export_gpio < 0) {
+                continue;
+            }
+            measure(&backends[b], op, iterations, rounds, &res[count]);
+            if (res[count].errors) {
+                fprintf(stderr, "%s %s: %llu failed operations\n", res[count].backend,
+                        res[count].op, (unsigned long long) res[count].errors);
+                ret = EXIT_FAILURE;
+            }
+            count++;
+        }
+    }
+    cleanup();
+
+    if (json != NULL && (out = fopen(json, "w")) == NULL) {
+        perror(json);
+        return EXIT_FAILURE;
+    }
+    write_json(out, res, count, iterations, rounds);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return ret;
+}
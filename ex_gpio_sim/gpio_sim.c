@@ -0,0 +1,1116 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux gpio_sim
+ *
+ *          FUSE simulator of the sysfs GPIO and IIO files of the BBB, so
+ *          the examples can be run, benchmarked and regression tested on
+ *          any Linux host. The mount point stands for /sys:
+ *
+ *          class/gpio/export, unexport
+ *          class/gpio/gpioN/direction, value, edge, active_low
+ *          bus/iio/devices/iio:device0/name, in_voltage0..7_raw
+ *          sim/inject
+ *
+ *          The files behave like the kernel ones: export creates gpioN as
+ *          input (EBUSY if already exported), writing value of an input
+ *          fails with EPERM, direction takes in, out, high and low, value
+ *          and direction accept a trailing newline or NUL. On an input
+ *          with edge != none every matching level change makes poll()
+ *          return POLLPRI | POLLERR until the file is read again.
+ *
+ *          Inputs and the ADC channels are driven by
+ *
+ *          -w target=shape    a waveform, target gpioN or ainN, shape
+ *                             const:v
+ *                             square:period_ms[:lo:hi[:duty_%]]
+ *                             sine:period_ms[:lo:hi]
+ *                             ramp:period_ms[:lo:hi]
+ *                             noise:period_ms[:lo:hi]  (new value per period)
+ *                             lo/hi default to 0/1 for gpio, 0/4095 for ain
+ *          -s script          lines "time_ms target value", '#' comments,
+ *                             a last line "loop" repeats the script
+ *          sim/inject         write "target value" lines at run time
+ *
+ *          The waveforms and the script are evaluated every tick (-t,
+ *          default 1000 us). Every operation can be slowed down to the
+ *          latency of the real hardware with -l op=us[,op=us...], plus a
+ *          random 0..jitter us with -j. Operations: export, unexport,
+ *          direction, edge, value_read, value_write, adc_read.
+ *
+ *          With -v every GPIO write is printed as "time_us gpioN what value".
+ *
+ *          Build the examples against the mount with SYSFS_ROOT:
+ *
+ *          mkdir /tmp/sim
+ *          gpio_sim -w gpio49=square:200 -w ain4=sine:2000 /tmp/sim
+ *          make -C ../examlib HOST=1 SYSFS_ROOT=/tmp/sim
+ *          fusermount -u /tmp/sim
+ *
+ *          Usage: gpio_sim [-w target=shape]... [-s script] [-l op=us,...]
+ *                          [-j jitter_us] [-t tick_us] [-v] mountpoint
+ *                          [fuse options]
+ *
+ * \file    gpio_sim.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#define FUSE_USE_VERSION 29
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <fuse.h>
+
+/* Define some useful constants */
+#define SIM_GPIOS		128
+#define SIM_AIN			8
+#define ADC_MAX			4095
+#define MAX_WAVES		32
+#define MAX_STEPS		1024
+#define MAX_MSG_SIZE		64
+#define MAX_STR_BUF		64
+#define MAX_FUSE_ARGS		32
+#define DEF_TICK_US		1000
+#define IIO_NAME		"TI-am335x-adc"
+
+/* Same as DEFAULT_POLLMASK of the kernel */
+#define SIM_POLLMASK		(POLLIN | POLLOUT | POLLRDNORM | POLLWRNORM)
+
+enum {
+    DIR_IN = 0,
+    DIR_OUT,
+};
+
+enum {
+    EDGE_NONE = 0,
+    EDGE_RISING,
+    EDGE_FALLING,
+    EDGE_BOTH,
+};
+
+static const char *edge_name[] = { "none", "rising", "falling", "both" };
+
+/* Operations with injectable latency */
+enum {
+    LAT_EXPORT = 0,
+    LAT_UNEXPORT,
+    LAT_DIRECTION,
+    LAT_EDGE,
+    LAT_VALUE_READ,
+    LAT_VALUE_WRITE,
+    LAT_ADC_READ,
+    LAT_COUNT
+};
+
+static const char *lat_name[LAT_COUNT] = {
+    "export", "unexport", "direction", "edge", "value_read", "value_write", "adc_read"
+};
+
+/* Files of the tree */
+enum node_type {
+    NODE_DIR = 0,
+    NODE_EXPORT,
+    NODE_UNEXPORT,
+    NODE_DIRECTION,
+    NODE_VALUE,
+    NODE_EDGE,
+    NODE_ACTIVE_LOW,
+    NODE_IIO_NAME,
+    NODE_AIN,
+    NODE_INJECT,
+};
+
+struct node {
+    enum node_type type;
+    int            index;	/* GPIO or ADC channel, -1 for none */
+};
+
+/* An open file, kept in fi->fh */
+struct sim_handle {
+    struct node              node;
+    uint32_t                 event;	/* Edge events seen by the last read */
+    struct fuse_pollhandle  *ph;	/* Pending poll() */
+    struct sim_handle       *next;	/* Open value files of the same line */
+};
+
+/* One GPIO line */
+struct sim_line {
+    int      exported;
+    int      dir;
+    int      latch;		/* Written value of an output */
+    int      input;		/* Level driven from outside */
+    int      edge;
+    int      active_low;
+    uint32_t event;		/* Edge counter */
+    struct sim_handle *handles;
+};
+
+/* Waveform on an input or ADC channel */
+enum wave_shape {
+    WAVE_CONST = 0,
+    WAVE_SQUARE,
+    WAVE_SINE,
+    WAVE_RAMP,
+    WAVE_NOISE,
+};
+
+struct wave {
+    int             ain;	/* 1 = ADC channel, 0 = GPIO */
+    int             index;
+    enum wave_shape shape;
+    double          period_ms;
+    int32_t         lo, hi;
+    double          duty;
+};
+
+/* Script step */
+struct step {
+    double  t_ms;
+    int     ain;
+    int     index;
+    int32_t value;
+};
+
+/* Simulator state, protected by sim_lock */
+static pthread_mutex_t  sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct sim_line  lines[SIM_GPIOS];
+static int32_t          ain[SIM_AIN];
+
+static struct wave      waves[MAX_WAVES];
+static unsigned         num_waves;
+static struct step      steps[MAX_STEPS];
+static unsigned         num_steps;
+static int              script_loop;
+
+static uint32_t         lat_us[LAT_COUNT];
+static uint32_t         jitter_us;
+static uint32_t         tick_us = DEF_TICK_US;
+static int              verbose;
+
+static pthread_t        tick_thread;
+static volatile int     running;
+static uint64_t         start_ns;
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns
+ ***************************************************************************
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Injected latency of an operation
+ ***************************************************************************
+ */
+static void sim_delay(int op)
+{
+    static __thread unsigned seed;
+    uint32_t us = lat_us[op];
+
+    if (jitter_us) {
+        if (seed == 0) {
+            seed = (unsigned) now_ns() | 1;
+        }
+        us += rand_r(&seed) % (jitter_us + 1);
+    }
+    if (us) {
+        usleep(us);
+    }
+}
+
+/*
+ ***************************************************************************
+ * Path to node, -ENOENT for paths that do not exist
+ ***************************************************************************
+ */
+static int parse_path(const char *path, struct node *n)
+{
+    static const char *dirs[] = {
+        "/", "/class", "/class/gpio", "/bus", "/bus/iio", "/bus/iio/devices",
+        "/bus/iio/devices/iio:device0", "/sim"
+    };
+    char file[MAX_STR_BUF];
+    unsigned i;
+    int idx, len;
+
+    n->index = -1;
+    for (i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+        if (strcmp(path, dirs[i]) == 0) {
+            n->type = NODE_DIR;
+            return 0;
+        }
+    }
+    if (strcmp(path, "/class/gpio/export") == 0) {
+        n->type = NODE_EXPORT;
+        return 0;
+    }
+    if (strcmp(path, "/class/gpio/unexport") == 0) {
+        n->type = NODE_UNEXPORT;
+        return 0;
+    }
+    if (strcmp(path, "/sim/inject") == 0) {
+        n->type = NODE_INJECT;
+        return 0;
+    }
+    if (strcmp(path, "/bus/iio/devices/iio:device0/name") == 0) {
+        n->type = NODE_IIO_NAME;
+        return 0;
+    }
+    if (sscanf(path, "/bus/iio/devices/iio:device0/in_voltage%d_raw%n", &idx, &len) == 1 &&
+        path[len] == '\0' && idx >= 0 && idx < SIM_AIN) {
+        n->type  = NODE_AIN;
+        n->index = idx;
+        return 0;
+    }
+
+    /* class/gpio/gpioN[/file] of an exported line */
+    if (sscanf(path, "/class/gpio/gpio%d%n", &idx, &len) != 1 ||
+        idx < 0 || idx >= SIM_GPIOS || !lines[idx].exported) {
+        return -ENOENT;
+    }
+    n->index = idx;
+    if (path[len] == '\0') {
+        n->type = NODE_DIR;
+        return 0;
+    }
+    if (path[len] != '/' || strlen(path + len + 1) >= sizeof(file)) {
+        return -ENOENT;
+    }
+    strcpy(file, path + len + 1);
+    if (strcmp(file, "direction") == 0) {
+        n->type = NODE_DIRECTION;
+    } else if (strcmp(file, "value") == 0) {
+        n->type = NODE_VALUE;
+    } else if (strcmp(file, "edge") == 0) {
+        n->type = NODE_EDGE;
+    } else if (strcmp(file, "active_low") == 0) {
+        n->type = NODE_ACTIVE_LOW;
+    } else {
+        return -ENOENT;
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Line state, called with sim_lock held
+ ***************************************************************************
+ */
+static int line_level(const struct sim_line *l)
+{
+    return (l->dir == DIR_OUT ? l->latch : l->input) ^ l->active_low;
+}
+
+/* Line of a gpioN file, NULL for the other files */
+static struct sim_line *node_line(const struct node *n)
+{
+    return (n->index >= 0 && n->type != NODE_AIN) ? &lines[n->index] : NULL;
+}
+
+/* Wake up the pollers of a line after an edge */
+static void line_notify(struct sim_line *l)
+{
+    struct sim_handle *h;
+
+    for (h = l->handles; h != NULL; h = h->next) {
+        if (h->ph != NULL) {
+            fuse_notify_poll(h->ph);
+            fuse_pollhandle_destroy(h->ph);
+            h->ph = NULL;
+        }
+    }
+}
+
+/* Drive an input from outside, counts an edge if it matches the edge setting */
+static void line_drive(int gpio, int32_t value)
+{
+    struct sim_line *l = &lines[gpio];
+    int old = line_level(l), now;
+
+    l->input = value != 0;
+    if (!l->exported || l->dir != DIR_IN) {
+        return;
+    }
+    now = line_level(l);
+    if (now == old || l->edge == EDGE_NONE) {
+        return;
+    }
+    if (l->edge == EDGE_BOTH || (l->edge == EDGE_RISING && now) ||
+        (l->edge == EDGE_FALLING && !now)) {
+        l->event++;
+        line_notify(l);
+    }
+}
+
+static void sim_drive(int is_ain, int index, int32_t value)
+{
+    if (is_ain) {
+        ain[index] = value < 0 ? 0 : (value > ADC_MAX ? ADC_MAX : value);
+    } else {
+        line_drive(index, value);
+    }
+}
+
+/*
+ ***************************************************************************
+ * Parse "gpioN" or "ainN"
+ ***************************************************************************
+ */
+static int parse_target(const char *s, int *is_ain, int *index)
+{
+    int len;
+
+    if (sscanf(s, "gpio%d%n", index, &len) == 1 && s[len] == '\0' &&
+        *index >= 0 && *index < SIM_GPIOS) {
+        *is_ain = 0;
+        return 0;
+    }
+    if (sscanf(s, "ain%d%n", index, &len) == 1 && s[len] == '\0' &&
+        *index >= 0 && *index < SIM_AIN) {
+        *is_ain = 1;
+        return 0;
+    }
+    return -1;
+}
+
+/* Copy a written message without the trailing newline or NUL */
+static void msg_copy(char *dst, const char *buf, size_t size)
+{
+    size_t n = size < MAX_MSG_SIZE - 1 ? size : MAX_MSG_SIZE - 1;
+
+    memcpy(dst, buf, n);
+    dst[n] = '\0';
+    dst[strcspn(dst, "\n")] = '\0';
+}
+
+/*
+ ***************************************************************************
+ * FUSE callbacks
+ ***************************************************************************
+ */
+static int sim_getattr(const char *path, struct stat *st)
+{
+    struct node n;
+    int ret;
+
+    memset(st, 0, sizeof(*st));
+    pthread_mutex_lock(&sim_lock);
+    ret = parse_path(path, &n);
+    pthread_mutex_unlock(&sim_lock);
+    if (ret < 0) {
+        return ret;
+    }
+
+    st->st_uid = getuid();
+    st->st_gid = getgid();
+    if (n.type == NODE_DIR) {
+        st->st_mode  = S_IFDIR | 0755;
+        st->st_nlink = 2;
+        return 0;
+    }
+    st->st_nlink = 1;
+    st->st_size  = 4096;
+    switch (n.type) {
+    case NODE_EXPORT:
+    case NODE_UNEXPORT:
+    case NODE_INJECT:
+        st->st_mode = S_IFREG | 0200;
+        break;
+    case NODE_IIO_NAME:
+    case NODE_AIN:
+        st->st_mode = S_IFREG | 0444;
+        break;
+    default:
+        st->st_mode = S_IFREG | 0644;
+    }
+    return 0;
+}
+
+static int sim_readdir(const char *path, void *buf, fuse_fill_dir_t filler, off_t off,
+                       struct fuse_file_info *fi)
+{
+    static const char *gpio_files[] = { "direction", "value", "edge", "active_low" };
+    char name[MAX_STR_BUF];
+    struct node n;
+    int i, ret;
+
+    pthread_mutex_lock(&sim_lock);
+    ret = parse_path(path, &n);
+    if (ret == 0 && n.type != NODE_DIR) {
+        ret = -ENOTDIR;
+    }
+    if (ret < 0) {
+        pthread_mutex_unlock(&sim_lock);
+        return ret;
+    }
+
+    filler(buf, ".", NULL, 0);
+    filler(buf, "..", NULL, 0);
+    if (n.index >= 0) {
+        for (i = 0; i < 4; i++) {
+            filler(buf, gpio_files[i], NULL, 0);
+        }
+    } else if (strcmp(path, "/") == 0) {
+        filler(buf, "class", NULL, 0);
+        filler(buf, "bus", NULL, 0);
+        filler(buf, "sim", NULL, 0);
+    } else if (strcmp(path, "/class") == 0) {
+        filler(buf, "gpio", NULL, 0);
+    } else if (strcmp(path, "/class/gpio") == 0) {
+        filler(buf, "export", NULL, 0);
+        filler(buf, "unexport", NULL, 0);
+        for (i = 0; i < SIM_GPIOS; i++) {
+            if (lines[i].exported) {
+                snprintf(name, sizeof(name), "gpio%d", i);
+                filler(buf, name, NULL, 0);
+            }
+        }
+    } else if (strcmp(path, "/bus") == 0) {
+        filler(buf, "iio", NULL, 0);
+    } else if (strcmp(path, "/bus/iio") == 0) {
+        filler(buf, "devices", NULL, 0);
+    } else if (strcmp(path, "/bus/iio/devices") == 0) {
+        filler(buf, "iio:device0", NULL, 0);
+    } else if (strcmp(path, "/sim") == 0) {
+        filler(buf, "inject", NULL, 0);
+    } else {
+        filler(buf, "name", NULL, 0);
+        for (i = 0; i < SIM_AIN; i++) {
+            snprintf(name, sizeof(name), "in_voltage%d_raw", i);
+            filler(buf, name, NULL, 0);
+        }
+    }
+    pthread_mutex_unlock(&sim_lock);
+    return 0;
+}
+
+static int sim_open(const char *path, struct fuse_file_info *fi)
+{
+    struct sim_handle *h;
+    struct node n;
+    int ret;
+
+    if ((h = calloc(1, sizeof(*h))) == NULL) {
+        return -ENOMEM;
+    }
+    pthread_mutex_lock(&sim_lock);
+    ret = parse_path(path, &n);
+    if (ret == 0 && n.type == NODE_DIR) {
+        ret = -EISDIR;
+    }
+    if (ret < 0) {
+        pthread_mutex_unlock(&sim_lock);
+        free(h);
+        return ret;
+    }
+    h->node = n;
+    if (n.type == NODE_VALUE) {
+        h->event = lines[n.index].event;
+        h->next  = lines[n.index].handles;
+        lines[n.index].handles = h;
+    }
+    pthread_mutex_unlock(&sim_lock);
+
+    fi->fh        = (uintptr_t) h;
+    fi->direct_io = 1;		/* Every read reaches the simulator */
+    return 0;
+}
+
+static int sim_release(const char *path, struct fuse_file_info *fi)
+{
+    struct sim_handle *h = (struct sim_handle *) (uintptr_t) fi->fh;
+    struct sim_handle **p;
+
+    pthread_mutex_lock(&sim_lock);
+    if (h->node.type == NODE_VALUE) {
+        for (p = &lines[h->node.index].handles; *p != NULL; p = &(*p)->next) {
+            if (*p == h) {
+                *p = h->next;
+                break;
+            }
+        }
+    }
+    if (h->ph != NULL) {
+        fuse_pollhandle_destroy(h->ph);
+    }
+    pthread_mutex_unlock(&sim_lock);
+    free(h);
+    return 0;
+}
+
+static int sim_read(const char *path, char *buf, size_t size, off_t off,
+                    struct fuse_file_info *fi)
+{
+    struct sim_handle *h = (struct sim_handle *) (uintptr_t) fi->fh;
+    struct sim_line *l = node_line(&h->node);
+    char text[MAX_STR_BUF];
+    int len;
+
+    if (h->node.type == NODE_AIN) {
+        sim_delay(LAT_ADC_READ);
+    } else if (h->node.type == NODE_VALUE) {
+        sim_delay(LAT_VALUE_READ);
+    }
+
+    pthread_mutex_lock(&sim_lock);
+    if (l != NULL && !l->exported) {
+        pthread_mutex_unlock(&sim_lock);
+        return -ENODEV;
+    }
+    switch (h->node.type) {
+    case NODE_DIRECTION:
+        len = snprintf(text, sizeof(text), "%s\n", l->dir == DIR_OUT ? "out" : "in");
+        break;
+    case NODE_VALUE:
+        len = snprintf(text, sizeof(text), "%d\n", line_level(l));
+        h->event = l->event;
+        break;
+    case NODE_EDGE:
+        len = snprintf(text, sizeof(text), "%s\n", edge_name[l->edge]);
+        break;
+    case NODE_ACTIVE_LOW:
+        len = snprintf(text, sizeof(text), "%d\n", l->active_low);
+        break;
+    case NODE_IIO_NAME:
+        len = snprintf(text, sizeof(text), "%s\n", IIO_NAME);
+        break;
+    case NODE_AIN:
+        len = snprintf(text, sizeof(text), "%d\n", ain[h->node.index]);
+        break;
+    default:
+        pthread_mutex_unlock(&sim_lock);
+        return -EINVAL;
+    }
+    pthread_mutex_unlock(&sim_lock);
+
+    if (off >= len) {
+        return 0;
+    }
+    if (off + size > (size_t) len) {
+        size = len - off;
+    }
+    memcpy(buf, text + off, size);
+    return size;
+}
+
+/* Print a GPIO write with -v */
+static void trace_write(int gpio, const char *what, const char *value)
+{
+    if (verbose) {
+        printf("%llu gpio%d %s %s\n", (unsigned long long) ((now_ns() - start_ns) / 1000),
+               gpio, what, value);
+        fflush(stdout);
+    }
+}
+
+/* "target value" lines written to sim/inject, called with sim_lock held */
+static int inject(const char *buf, size_t size)
+{
+    char msg[MAX_MSG_SIZE * 4], target[MAX_STR_BUF], *line, *save;
+    int is_ain, index;
+    long value;
+    size_t n = size < sizeof(msg) - 1 ? size : sizeof(msg) - 1;
+
+    memcpy(msg, buf, n);
+    msg[n] = '\0';
+    for (line = strtok_r(msg, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save)) {
+        if (sscanf(line, "%63s %ld", target, &value) != 2 ||
+            parse_target(target, &is_ain, &index) < 0) {
+            return -EINVAL;
+        }
+        sim_drive(is_ain, index, value);
+    }
+    return 0;
+}
+
+static int sim_write(const char *path, const char *buf, size_t size, off_t off,
+                     struct fuse_file_info *fi)
+{
+    struct sim_handle *h = (struct sim_handle *) (uintptr_t) fi->fh;
+    struct sim_line *l;
+    char msg[MAX_MSG_SIZE], *end;
+    long v;
+    int ret = 0;
+
+    msg_copy(msg, buf, size);
+    switch (h->node.type) {
+    case NODE_EXPORT:
+        sim_delay(LAT_EXPORT);
+        break;
+    case NODE_UNEXPORT:
+        sim_delay(LAT_UNEXPORT);
+        break;
+    case NODE_DIRECTION:
+        sim_delay(LAT_DIRECTION);
+        break;
+    case NODE_EDGE:
+        sim_delay(LAT_EDGE);
+        break;
+    case NODE_VALUE:
+        sim_delay(LAT_VALUE_WRITE);
+        break;
+    default:
+        break;
+    }
+
+    pthread_mutex_lock(&sim_lock);
+    l = node_line(&h->node);
+    if (l != NULL && !l->exported) {
+        pthread_mutex_unlock(&sim_lock);
+        return -ENODEV;
+    }
+    switch (h->node.type) {
+    case NODE_EXPORT:
+    case NODE_UNEXPORT:
+        v = strtol(msg, &end, 10);
+        if (end == msg || *end != '\0' || v < 0 || v >= SIM_GPIOS) {
+            ret = -EINVAL;
+            break;
+        }
+        l = &lines[v];
+        if (h->node.type == NODE_EXPORT) {
+            if (l->exported) {
+                ret = -EBUSY;
+                break;
+            }
+            l->exported   = 1;
+            l->dir        = DIR_IN;
+            l->edge       = EDGE_NONE;
+            l->active_low = 0;
+            trace_write(v, "export", "1");
+        } else {
+            if (!l->exported) {
+                ret = -EINVAL;
+                break;
+            }
+            l->exported = 0;
+            l->event++;
+            line_notify(l);
+            trace_write(v, "export", "0");
+        }
+        break;
+
+    case NODE_DIRECTION:
+        if (strcmp(msg, "in") == 0) {
+            l->dir = DIR_IN;
+        } else if (strcmp(msg, "out") == 0 || strcmp(msg, "low") == 0) {
+            l->dir   = DIR_OUT;
+            l->latch = 0;
+        } else if (strcmp(msg, "high") == 0) {
+            l->dir   = DIR_OUT;
+            l->latch = 1;
+        } else {
+            ret = -EINVAL;
+            break;
+        }
+        trace_write(h->node.index, "direction", msg);
+        break;
+
+    case NODE_VALUE:
+        v = strtol(msg, &end, 10);
+        if (end == msg || *end != '\0') {
+            ret = -EINVAL;
+        } else if (l->dir != DIR_OUT) {
+            ret = -EPERM;
+        } else {
+            l->latch = (v != 0) ^ l->active_low;
+            trace_write(h->node.index, "value", v ? "1" : "0");
+        }
+        break;
+
+    case NODE_EDGE:
+        for (v = 0; v < 4 && strcmp(msg, edge_name[v]) != 0; v++) {
+            ;
+        }
+        if (v == 4) {
+            ret = -EINVAL;
+        } else {
+            l->edge = v;
+        }
+        break;
+
+    case NODE_ACTIVE_LOW:
+        v = strtol(msg, &end, 10);
+        if (end == msg || *end != '\0') {
+            ret = -EINVAL;
+        } else {
+            l->active_low = v != 0;
+        }
+        break;
+
+    case NODE_INJECT:
+        ret = inject(buf, size);
+        break;
+
+    default:
+        ret = -EACCES;
+    }
+    pthread_mutex_unlock(&sim_lock);
+    return ret < 0 ? ret : (int) size;
+}
+
+/* Shell redirections open with O_TRUNC */
+static int sim_truncate(const char *path, off_t size)
+{
+    struct node n;
+    int ret;
+
+    pthread_mutex_lock(&sim_lock);
+    ret = parse_path(path, &n);
+    pthread_mutex_unlock(&sim_lock);
+    return ret < 0 ? ret : (n.type == NODE_DIR ? -EISDIR : 0);
+}
+
+static int sim_poll(const char *path, struct fuse_file_info *fi,
+                    struct fuse_pollhandle *ph, unsigned *reventsp)
+{
+    struct sim_handle *h = (struct sim_handle *) (uintptr_t) fi->fh;
+    unsigned revents = SIM_POLLMASK;
+
+    pthread_mutex_lock(&sim_lock);
+    if (h->node.type == NODE_VALUE && h->event != lines[h->node.index].event) {
+        revents |= POLLPRI | POLLERR;
+    }
+    if (ph != NULL) {
+        if (h->ph != NULL) {
+            fuse_pollhandle_destroy(h->ph);
+        }
+        h->ph = ph;
+    }
+    pthread_mutex_unlock(&sim_lock);
+
+    *reventsp = revents;
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Waveforms and script, evaluated every tick
+ ***************************************************************************
+ */
+static int32_t wave_value(const struct wave *w, double t_ms, unsigned *seed)
+{
+    double phase = w->period_ms > 0 ? fmod(t_ms, w->period_ms) / w->period_ms : 0;
+
+    switch (w->shape) {
+    case WAVE_SQUARE:
+        return phase < w->duty ? w->hi : w->lo;
+    case WAVE_SINE:
+        return w->lo + (w->hi - w->lo) * (0.5 + 0.5 * sin(2 * M_PI * phase));
+    case WAVE_RAMP:
+        return w->lo + (w->hi - w->lo) * phase;
+    case WAVE_NOISE:
+        return w->lo + rand_r(seed) % (w->hi - w->lo + 1);
+    default:
+        return w->lo;
+    }
+}
+
+static void *tick_main(void *arg)
+{
+    struct timespec next;
+    unsigned seed = 1, i, pos = 0;
+    double t_ms, base_ms = 0, noise_ms[MAX_WAVES];
+    int32_t noise[MAX_WAVES];
+
+    for (i = 0; i < num_waves; i++) {
+        noise_ms[i] = -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (running) {
+        t_ms = (now_ns() - start_ns) / 1e6;
+
+        pthread_mutex_lock(&sim_lock);
+        for (i = 0; i < num_waves; i++) {
+            if (waves[i].shape != WAVE_NOISE) {
+                sim_drive(waves[i].ain, waves[i].index, wave_value(&waves[i], t_ms, &seed));
+                continue;
+            }
+            /* Noise holds a value for one period */
+            if (noise_ms[i] < 0 || t_ms - noise_ms[i] >= waves[i].period_ms) {
+                noise[i]    = wave_value(&waves[i], t_ms, &seed);
+                noise_ms[i] = t_ms;
+            }
+            sim_drive(waves[i].ain, waves[i].index, noise[i]);
+        }
+        while (pos < num_steps && steps[pos].t_ms <= t_ms - base_ms) {
+            sim_drive(steps[pos].ain, steps[pos].index, steps[pos].value);
+            pos++;
+        }
+        if (pos == num_steps && script_loop && num_steps &&
+            t_ms - base_ms >= steps[num_steps - 1].t_ms) {
+            pos      = 0;
+            base_ms += steps[num_steps - 1].t_ms > 0 ? steps[num_steps - 1].t_ms : 1;
+        }
+        pthread_mutex_unlock(&sim_lock);
+
+        next.tv_nsec += tick_us * 1000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+/* Started after fuse_main() has mounted and daemonized */
+static void *sim_init(struct fuse_conn_info *conn)
+{
+    start_ns = now_ns();
+    running  = 1;
+    if (pthread_create(&tick_thread, NULL, tick_main, NULL) != 0) {
+        running = 0;
+        fprintf(stderr, "Can not start the waveform thread\n");
+    }
+    return NULL;
+}
+
+static void sim_destroy(void *data)
+{
+    if (running) {
+        running = 0;
+        pthread_join(tick_thread, NULL);
+    }
+}
+
+static const struct fuse_operations sim_ops = {
+    .getattr  = sim_getattr,
+    .readdir  = sim_readdir,
+    .open     = sim_open,
+    .release  = sim_release,
+    .read     = sim_read,
+    .write    = sim_write,
+    .truncate = sim_truncate,
+    .poll     = sim_poll,
+    .init     = sim_init,
+    .destroy  = sim_destroy,
+};
+
+/*
+ ***************************************************************************
+ * Command line
+ ***************************************************************************
+ */
+static int parse_wave(char *spec)
+{
+    struct wave *w = &waves[num_waves];
+    char *eq = strchr(spec, '='), *shape, *save, *arg;
+    double a[4];
+    int n = 0;
+
+    if (num_waves == MAX_WAVES || eq == NULL) {
+        return -1;
+    }
+    *eq = '\0';
+    if (parse_target(spec, &w->ain, &w->index) < 0) {
+        return -1;
+    }
+    w->lo   = 0;
+    w->hi   = w->ain ? ADC_MAX : 1;
+    w->duty = 0.5;
+
+    if ((shape = strtok_r(eq + 1, ":", &save)) == NULL) {
+        return -1;
+    }
+    while (n < 4 && (arg = strtok_r(NULL, ":", &save)) != NULL) {
+        a[n++] = atof(arg);
+    }
+
+    if (strcmp(shape, "const") == 0 && n == 1) {
+        w->shape = WAVE_CONST;
+        w->lo    = a[0];
+    } else if (n >= 1 && a[0] > 0) {
+        if (strcmp(shape, "square") == 0) {
+            w->shape = WAVE_SQUARE;
+        } else if (strcmp(shape, "sine") == 0) {
+            w->shape = WAVE_SINE;
+        } else if (strcmp(shape, "ramp") == 0) {
+            w->shape = WAVE_RAMP;
+        } else if (strcmp(shape, "noise") == 0) {
+            w->shape = WAVE_NOISE;
+        } else {
+            return -1;
+        }
+        w->period_ms = a[0];
+        if (n >= 3) {
+            w->lo = a[1];
+            w->hi = a[2];
+        }
+        if (n == 4) {
+            w->duty = a[3] / 100.0;
+        }
+        if (w->hi < w->lo) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+    num_waves++;
+    return 0;
+}
+
+static int parse_script(const char *file)
+{
+    char line[MAX_STR_BUF * 2], target[MAX_STR_BUF];
+    struct step *s;
+    FILE *f;
+    int lineno = 0, value;
+
+    if ((f = fopen(file, "r")) == NULL) {
+        perror(file);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineno++;
+        line[strcspn(line, "#\n")] = '\0';
+        if (sscanf(line, "%63s", target) != 1) {
+            continue;
+        }
+        if (strcmp(target, "loop") == 0) {
+            script_loop = 1;
+            continue;
+        }
+        s = &steps[num_steps];
+        if (num_steps == MAX_STEPS ||
+            sscanf(line, "%lf %63s %d", &s->t_ms, target, &value) != 3 ||
+            parse_target(target, &s->ain, &s->index) < 0 ||
+            (num_steps && s->t_ms < steps[num_steps - 1].t_ms)) {
+            fprintf(stderr, "%s:%d: expected \"time_ms target value\" in time order\n",
+                    file, lineno);
+            fclose(f);
+            return -1;
+        }
+        s->value = value;
+        num_steps++;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int parse_latency(char *spec)
+{
+    char *item, *save, *eq;
+    int i;
+
+    for (item = strtok_r(spec, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+        if ((eq = strchr(item, '=')) == NULL) {
+            return -1;
+        }
+        *eq = '\0';
+        for (i = 0; i < LAT_COUNT && strcmp(item, lat_name[i]) != 0; i++) {
+            ;
+        }
+        if (i == LAT_COUNT) {
+            return -1;
+        }
+        lat_us[i] = atoi(eq + 1);
+    }
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-w target=shape]... [-s script] [-l op=us,...]\n"
+            "                [-j jitter_us] [-t tick_us] [-v] mountpoint [fuse options]\n", prog);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char *fuse_argv[MAX_FUSE_ARGS];
+    int fuse_argc = 0, opt, i;
+
+    /* Own options first, the rest goes to fuse */
+    while ((opt = getopt(argc, argv, "+w:s:l:j:t:v")) != -1) {
+        switch (opt) {
+        case 'w':
+            if (parse_wave(optarg) < 0) {
+                fprintf(stderr, "Invalid waveform: %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 's':
+            if (parse_script(optarg) < 0) {
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'l':
+            if (parse_latency(optarg) < 0) {
+                fprintf(stderr, "Invalid latency, expected op=us with op one of "
+                        "export unexport direction edge value_read value_write adc_read\n");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'j':
+            jitter_us = atoi(optarg);
+            break;
+        case 't':
+            tick_us = atoi(optarg);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind >= argc || tick_us == 0 || argc - optind + 5 > MAX_FUSE_ARGS) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* No kernel caching, the files change without a write */
+    fuse_argv[fuse_argc++] = argv[0];
+    fuse_argv[fuse_argc++] = "-o";
+    fuse_argv[fuse_argc++] = "entry_timeout=0,attr_timeout=0,negative_timeout=0";
+    for (i = optind; i < argc; i++) {
+        fuse_argv[fuse_argc++] = argv[i];
+    }
+    fuse_argv[fuse_argc] = NULL;
+
+    /* -v prints to the terminal, so stay in the foreground */
+    if (verbose) {
+        fuse_argv[fuse_argc++] = "-f";
+        fuse_argv[fuse_argc]   = NULL;
+    }
+
+    return fuse_main(fuse_argc, fuse_argv, &sim_ops, NULL);
+}
@@ -1,39 +1,45 @@
 #include<time.h>
 #include<sys/time.h>
 #include<signal.h>
+#include<pthread.h>
 #include<stdio.h>
 #include<stdlib.h>
 
+#include "alog.h"
+
 time_t timerid_1, timerid_2, timerid_3, timerid_4;
 struct sigevent se_timer1, se_timer2, se_timer3, se_timer4;
 struct itimerspec ts_1, ts_2, ts_3, ts_4;
 
 volatile static int32_t counter1, counter2, counter3, counter4 = 0;
 
+/* Log formats, the callbacks log through alog instead of printf */
+static int fmt_counter;
+
 /* Callback functions -----------------------------------------*/
 
 /* Timer1 callback */
 void callback_1(union sigval arg)
 {
-    printf("Counter_1 value: %d\n", counter1++);
+    alog(fmt_counter, 1, counter1++);
 }
 
 /* Timer2 callback */
 void callback_2(union sigval arg)
 {
-    printf("Counter_2 value: %d\n", counter2++);
+    alog(fmt_counter, 2, counter2++);
 }
 
 /* Timer1 callback */
 void callback_3(union sigval arg)
 {
-    printf("Counter_3 value: %d\n", counter3++);
+    alog(fmt_counter, 3, counter3++);
 }
 
 /* Timer2 callback */
 void callback_4(union sigval arg)
 {
-    printf("Counter_4 value: %d\n", counter4++);
+    alog(fmt_counter, 4, counter4++);
 }
 
 
@@ -81,6 +87,21 @@ void start_timer(struct itimerspec *ts, time_t *timerid)
 /* Main function */
 int main (int argc, char **argv)
 {
+    sigset_t set;
+    int      sig;
+
+    /* Block SIGINT, the timer threads inherit the mask and main waits for it */
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    /* Start the logger */
+    fmt_counter = alog_register("Counter_%d value: %d\n");
+    if (fmt_counter < 0 || alog_start(stdout) < 0) {
+        fprintf(stderr, "alog setup failed\n");
+        return EXIT_FAILURE;
+    }
+
     /* Init timers */
     init_timer(callback_1, &se_timer1, &ts_1, &timerid_1, 0, 1);
     init_timer(callback_2, &se_timer2, &ts_2, &timerid_2, 500000000, 0);
@@ -93,10 +114,11 @@ int main (int argc, char **argv)
     start_timer(&ts_3, &timerid_3);
     start_timer(&ts_4, &timerid_4);
 
-    /* Endless loop */
-    while (1) { 
-        ;
-    }
+    /* Wait for Ctrl-C, then flush the log and report its cost */
+    sigwait(&set, &sig);
+    alog_stop();
+    printf("\nExit via Ctrl-C\n\n");
+    alog_report(stdout);
 
     return EXIT_SUCCESS;
 }
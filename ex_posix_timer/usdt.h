@@ -0,0 +1,65 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux usdt
+ *
+ *          Static user space probes (USDT) for the GPIO, ADC and timer
+ *          paths. With <sys/sdt.h> (package systemtap-sdt-dev) present the
+ *          Makefile defines HAVE_SYS_SDT_H and every probe compiles into a
+ *          single nop plus a note in .note.stapsdt naming the probe and
+ *          where its arguments live. Nothing runs until a tracer attaches:
+ *
+ *          readelf -n examlib | grep -A2 stapsdt
+ *          bpftrace -e 'usdt:./examlib:examlib:gpio_op { @ns[arg0] = hist(arg3); }'
+ *          perf buildid-cache --add gradedlab_1; perf probe sdt_gradedlab:buttons
+ *
+ *          Without <sys/sdt.h> the probes compile to nothing. The arguments
+ *          are not evaluated then, so they must be free of side effects.
+ *
+ *          USDT<n>(provider, name, args...) passes up to 5 integer
+ *          arguments.
+ *
+ * \file    usdt.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef USDT_H
+#define USDT_H
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+#define USDT0(p, n)			DTRACE_PROBE(p, n)
+#define USDT1(p, n, a)			DTRACE_PROBE1(p, n, a)
+#define USDT2(p, n, a, b)		DTRACE_PROBE2(p, n, a, b)
+#define USDT3(p, n, a, b, c)		DTRACE_PROBE3(p, n, a, b, c)
+#define USDT4(p, n, a, b, c, d)		DTRACE_PROBE4(p, n, a, b, c, d)
+#define USDT5(p, n, a, b, c, d, e)	DTRACE_PROBE5(p, n, a, b, c, d, e)
+
+#else
+
+/* sizeof() keeps the arguments "used" without evaluating them */
+#define USDT0(p, n)			do { } while (0)
+#define USDT1(p, n, a)			do { (void) sizeof(a); } while (0)
+#define USDT2(p, n, a, b)		do { (void) sizeof(a); (void) sizeof(b); } while (0)
+#define USDT3(p, n, a, b, c)		do { USDT2(p, n, a, b); (void) sizeof(c); } while (0)
+#define USDT4(p, n, a, b, c, d)		do { USDT3(p, n, a, b, c); (void) sizeof(d); } while (0)
+#define USDT5(p, n, a, b, c, d, e)	do { USDT4(p, n, a, b, c, d); (void) sizeof(e); } while (0)
+
+#endif /* HAVE_SYS_SDT_H */
+
+#endif /* USDT_H */
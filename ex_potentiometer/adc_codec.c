@@ -0,0 +1,230 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_codec
+ *
+ *          Delta / zig-zag / varint or bit-packing codec for raw ADC
+ *          sample streams. See adc_codec.h for the block layout.
+ *
+ * \file    adc_codec.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "adc_codec.h"
+
+/*
+ ***************************************************************************
+ * Zig-zag mapping, small negative and positive deltas become small
+ * unsigned numbers
+ ***************************************************************************
+ */
+static inline uint32_t zigzag(int32_t d)
+{
+    return ((uint32_t) d << 1) ^ (uint32_t) (d >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t z)
+{
+    return (int32_t) (z >> 1) ^ -(int32_t) (z & 1);
+}
+
+/*
+ ***************************************************************************
+ * Little endian helpers
+ ***************************************************************************
+ */
+static inline void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static inline uint16_t get16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+/*
+ ***************************************************************************
+ * Number of bits needed for v
+ ***************************************************************************
+ */
+static inline uint8_t bit_width(uint32_t v)
+{
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+/*
+ ***************************************************************************
+ * Encode count samples into one block. Returns the number of bytes
+ * written, at most ADC_CODEC_BLOCK_BOUND(count), or 0 on bad arguments.
+ ***************************************************************************
+ */
+size_t adc_codec_encode_block(const uint16_t *in, uint32_t count, uint8_t *out)
+{
+    uint32_t zz[ADC_CODEC_MAX_BLOCK];
+    uint32_t orall = 0, varint_size = 0, packed_size, i;
+    uint64_t acc = 0;
+    uint8_t  bits, *p = out + ADC_CODEC_HDR_SIZE;
+    int      nacc = 0;
+
+    if (count == 0 || count > ADC_CODEC_MAX_BLOCK) {
+        return 0;
+    }
+
+    /* Deltas, their bit width and their varint size in one pass */
+    for (i = 1; i < count; i++) {
+        zz[i] = zigzag((int32_t) in[i] - (int32_t) in[i - 1]);
+        orall |= zz[i];
+        varint_size += 1 + (zz[i] >= (1 << 7)) + (zz[i] >= (1 << 14));
+    }
+    bits = bit_width(orall);
+    packed_size = ((count - 1) * bits + 7) / 8;
+
+    put16(out, in[0]);
+    put16(out + 2, count);
+    out[5] = bits;
+
+    if (packed_size <= varint_size) {
+        out[4] = ADC_CODEC_PACKED;
+        for (i = 1; i < count; i++) {
+            acc |= (uint64_t) zz[i] << nacc;
+            nacc += bits;
+            while (nacc >= 8) {
+                *p++ = acc & 0xff;
+                acc >>= 8;
+                nacc -= 8;
+            }
+        }
+        if (nacc > 0) {
+            *p++ = acc & 0xff;
+        }
+    } else {
+        out[4] = ADC_CODEC_VARINT;
+        for (i = 1; i < count; i++) {
+            uint32_t v = zz[i];
+            while (v >= 0x80) {
+                *p++ = (v & 0x7f) | 0x80;
+                v >>= 7;
+            }
+            *p++ = v;
+        }
+    }
+
+    put16(out + 6, p - out - ADC_CODEC_HDR_SIZE);
+    return p - out;
+}
+
+/*
+ ***************************************************************************
+ * Decode one block. Returns the number of samples, or -1 if the block
+ * is truncated, corrupt or holds more than max samples.
+ ***************************************************************************
+ */
+int adc_codec_decode_block(const uint8_t *in, size_t avail, uint16_t *out, uint32_t max)
+{
+    const uint8_t *p, *end;
+    uint32_t count, i, mask;
+    uint64_t acc = 0;
+    int      nacc = 0;
+    uint8_t  bits;
+    int32_t  x;
+
+    if (avail < ADC_CODEC_HDR_SIZE) {
+        return -1;
+    }
+    count = get16(in + 2);
+    bits  = in[5];
+    p     = in + ADC_CODEC_HDR_SIZE;
+    end   = p + get16(in + 6);
+    if (count == 0 || count > max || end > in + avail || bits > 17) {
+        return -1;
+    }
+
+    x = out[0] = get16(in);
+
+    if (in[4] == ADC_CODEC_PACKED) {
+        if ((size_t) (end - p) * 8 < (size_t) (count - 1) * bits) {
+            return -1;
+        }
+        mask = (1u << bits) - 1;
+        for (i = 1; i < count; i++) {
+            while (nacc < bits) {
+                acc |= (uint64_t) *p++ << nacc;
+                nacc += 8;
+            }
+            x += unzigzag(acc & mask);
+            acc >>= bits;
+            nacc -= bits;
+            out[i] = x;
+        }
+    } else if (in[4] == ADC_CODEC_VARINT) {
+        for (i = 1; i < count; i++) {
+            uint32_t v = 0;
+            int shift = 0;
+            do {
+                if (p >= end || shift > 14) {
+                    return -1;
+                }
+                v |= (uint32_t) (*p & 0x7f) << shift;
+                shift += 7;
+            } while (*p++ & 0x80);
+            x += unzigzag(v);
+            out[i] = x;
+        }
+    } else {
+        return -1;
+    }
+    return count;
+}
+
+/*
+ ***************************************************************************
+ * Encode n samples as a stream of blocks of block_len samples and fill
+ * the block index. Returns the number of bytes written, or 0 if out or
+ * index are too small.
+ ***************************************************************************
+ */
+size_t adc_codec_encode(const uint16_t *in, uint32_t n, uint32_t block_len,
+                        uint8_t *out, size_t out_cap,
+                        struct adc_block_index *index, uint32_t index_cap, uint32_t *blocks)
+{
+    size_t   pos = 0, len;
+    uint32_t i, count, nblk = 0;
+
+    if (block_len == 0 || block_len > ADC_CODEC_MAX_BLOCK) {
+        return 0;
+    }
+
+    for (i = 0; i < n; i += count) {
+        count = (n - i < block_len) ? n - i : block_len;
+        if (nblk >= index_cap || pos + ADC_CODEC_BLOCK_BOUND(count) > out_cap) {
+            return 0;
+        }
+        index[nblk].offset = pos;
+        index[nblk].first  = i;
+        nblk++;
+
+        len = adc_codec_encode_block(in + i, count, out + pos);
+        pos += len;
+    }
+
+    *blocks = nblk;
+    return pos;
+}
@@ -0,0 +1,67 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_codec
+ *
+ *          Block based codec for raw ADC sample streams. Each block holds
+ *          up to ADC_CODEC_MAX_BLOCK samples: the first one verbatim,
+ *          the others as zig-zag encoded deltas. The payload is either
+ *          bit-packed with the block's widest delta or written as
+ *          varints, whichever is smaller.
+ *
+ *          Block layout (little endian):
+ *          +-------+-------+------+------+------+------------------+
+ *          | first | count | mode | bits | size | payload (size)   |
+ *          | u16   | u16   | u8   | u8   | u16  |                  |
+ *          +-------+-------+------+------+------+------------------+
+ *
+ *          The encoder fills an index with the offset and first sample
+ *          number of every block, so any block can be decoded on its own.
+ *
+ * \file    adc_codec.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef ADC_CODEC_H
+#define ADC_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADC_CODEC_MAX_BLOCK	4096
+#define ADC_CODEC_HDR_SIZE	8
+
+/* Payload encodings */
+#define ADC_CODEC_PACKED	0
+#define ADC_CODEC_VARINT	1
+
+/* Worst case size of an encoded block of n samples */
+#define ADC_CODEC_BLOCK_BOUND(n)	(ADC_CODEC_HDR_SIZE + 3 * (n))
+
+/* Index entry of one block */
+struct adc_block_index {
+    uint32_t offset;		/* Byte offset of the block header */
+    uint32_t first;		/* Number of the first sample in the block */
+};
+
+/* Prototypes */
+size_t adc_codec_encode_block(const uint16_t *in, uint32_t count, uint8_t *out);
+int    adc_codec_decode_block(const uint8_t *in, size_t avail, uint16_t *out, uint32_t max);
+size_t adc_codec_encode(const uint16_t *in, uint32_t n, uint32_t block_len,
+                        uint8_t *out, size_t out_cap,
+                        struct adc_block_index *index, uint32_t index_cap, uint32_t *blocks);
+
+#endif /* ADC_CODEC_H */
@@ -0,0 +1,210 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_codec_bench
+ *
+ *          Benchmark of the adc_codec. A synthetic potentiometer signal
+ *          (slow sine, random walk and a few LSB of noise, 12-bit) is
+ *          encoded and decoded repeatedly. Compression ratio against
+ *          raw 16-bit and against "%u\n" ASCII, and encode, decode and
+ *          random block decode throughput in MB/s of raw samples are
+ *          printed for every noise level.
+ *
+ *          Usage: adc_codec_bench [-n samples] [-b block_len] [-r rounds]
+ *
+ * \file    adc_codec_bench.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <math.h>
+
+#include "adc_codec.h"
+
+/* Define some useful constants */
+#define ADC_MAX			4095
+#define DEF_SAMPLES		(1 << 20)
+#define DEF_BLOCK		256
+#define DEF_ROUNDS		10
+
+/*
+ ***************************************************************************
+ * Monotonic time in seconds
+ ***************************************************************************
+ */
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ ***************************************************************************
+ * Synthetic potentiometer signal with the given noise amplitude in LSB
+ ***************************************************************************
+ */
+static void make_signal(uint16_t *s, uint32_t n, int noise)
+{
+    double walk = 0;
+    int32_t v;
+    uint32_t i;
+
+    srand(42);
+    for (i = 0; i < n; i++) {
+        walk += (rand() % 3) - 1;
+        v = 2048 + 1500 * sin(i * 2 * M_PI / 200000.0) + walk * 0.1;
+        if (noise > 0) {
+            v += (rand() % (2 * noise + 1)) - noise;
+        }
+        s[i] = v < 0 ? 0 : (v > ADC_MAX ? ADC_MAX : v);
+    }
+}
+
+/*
+ ***************************************************************************
+ * Size of the same samples as "%u\n" text
+ ***************************************************************************
+ */
+static size_t ascii_size(const uint16_t *s, uint32_t n)
+{
+    char buf[16];
+    size_t size = 0;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        size += snprintf(buf, sizeof(buf), "%u\n", s[i]);
+    }
+    return size;
+}
+
+/*
+ ***************************************************************************
+ * Run the benchmark for one noise level
+ ***************************************************************************
+ */
+static int run(uint32_t n, uint32_t block_len, int rounds, int noise)
+{
+    uint32_t nidx = (n + block_len - 1) / block_len, blocks = 0, i, k;
+    size_t   cap = (size_t) nidx * ADC_CODEC_BLOCK_BOUND(block_len);
+    uint16_t *sig = malloc(n * sizeof(*sig));
+    uint16_t *dec = malloc(n * sizeof(*dec));
+    uint8_t  *enc = malloc(cap);
+    struct adc_block_index *idx = malloc(nidx * sizeof(*idx));
+    double   t0, t_enc, t_dec, t_rnd, mb = n * sizeof(uint16_t) / 1e6;
+    size_t   size = 0;
+    int      r, ret = 0;
+
+    if (!sig || !dec || !enc || !idx) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    make_signal(sig, n, noise);
+
+    /* Encode */
+    t0 = now_s();
+    for (r = 0; r < rounds; r++) {
+        size = adc_codec_encode(sig, n, block_len, enc, cap, idx, nidx, &blocks);
+    }
+    t_enc = (now_s() - t0) / rounds;
+
+    /* Sequential decode of all blocks */
+    t0 = now_s();
+    for (r = 0; r < rounds; r++) {
+        for (k = 0; k < blocks; k++) {
+            adc_codec_decode_block(enc + idx[k].offset, size - idx[k].offset,
+                                   dec + idx[k].first, n - idx[k].first);
+        }
+    }
+    t_dec = (now_s() - t0) / rounds;
+
+    if (memcmp(sig, dec, n * sizeof(*sig)) != 0) {
+        fprintf(stderr, "Decode mismatch at noise %d\n", noise);
+        ret = -1;
+    }
+
+    /* Random access, one whole stream worth of random blocks */
+    srand(7);
+    t0 = now_s();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < blocks; i++) {
+            k = rand() % blocks;
+            adc_codec_decode_block(enc + idx[k].offset, size - idx[k].offset,
+                                   dec + idx[k].first, n - idx[k].first);
+        }
+    }
+    t_rnd = (now_s() - t0) / rounds;
+
+    printf("noise +-%-2d  %8zu bytes  ratio raw %5.2f  ascii %5.2f  "
+           "encode %7.1f MB/s  decode %7.1f MB/s  random %7.1f MB/s\n",
+           noise, size, (double) n * sizeof(uint16_t) / size,
+           (double) ascii_size(sig, n) / size,
+           mb / t_enc, mb / t_dec, mb / t_rnd);
+
+    free(sig);
+    free(dec);
+    free(enc);
+    free(idx);
+    return ret;
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    static const int noise[] = { 0, 1, 2, 4, 16 };
+    uint32_t n = DEF_SAMPLES, block_len = DEF_BLOCK;
+    int rounds = DEF_ROUNDS, opt, ret = 0;
+    unsigned i;
+
+    while ((opt = getopt(argc, argv, "n:b:r:")) != -1) {
+        switch (opt) {
+        case 'n':
+            n = atoi(optarg);
+            break;
+        case 'b':
+            block_len = atoi(optarg);
+            break;
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n samples] [-b block_len] [-r rounds]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (n == 0 || rounds <= 0 || block_len == 0 || block_len > ADC_CODEC_MAX_BLOCK) {
+        fprintf(stderr, "Invalid arguments\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u samples, %u samples per block, %d rounds\n", n, block_len, rounds);
+    for (i = 0; i < sizeof(noise) / sizeof(noise[0]); i++) {
+        if (run(n, block_len, rounds, noise[i]) < 0) {
+            ret = EXIT_FAILURE;
+        }
+    }
+    return ret;
+}
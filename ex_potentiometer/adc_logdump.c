@@ -0,0 +1,120 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_logdump
+ *
+ *          Export a range of an adc_ringlog file to CSV on stdout.
+ *
+ *          Usage: adc_logdump [-f first_seq] [-t last_seq]
+ *                             [-S start_s] [-E end_s] logfile
+ *
+ *          Sequence numbers select records by position, -S and -E by
+ *          their CLOCK_REALTIME time stamp in seconds since the epoch.
+ *          Records overwritten while reading are skipped.
+ *
+ * \file    adc_logdump.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "adc_ringlog.h"
+
+/* Define some useful constants */
+#define V_REF			1.8
+#define ADC_MAX			4095
+
+/*
+ ***************************************************************************
+ * Print the usage
+ ***************************************************************************
+ */
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [-f first_seq] [-t last_seq] [-S start_s] [-E end_s] logfile\n", name);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    struct adc_log        log;
+    struct adc_log_record r;
+    uint64_t first = 0, last = UINT64_MAX;
+    uint64_t start_ns = 0, end_ns = UINT64_MAX;
+    uint64_t seq, head;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:t:S:E:")) != -1) {
+        switch (opt) {
+        case 'f':
+            first = strtoull(optarg, NULL, 0);
+            break;
+        case 't':
+            last = strtoull(optarg, NULL, 0);
+            break;
+        case 'S':
+            start_ns = (uint64_t) (strtod(optarg, NULL) * 1e9);
+            break;
+        case 'E':
+            end_ns = (uint64_t) (strtod(optarg, NULL) * 1e9);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (adc_log_open_ro(&log, argv[optind]) < 0) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    /* Clip the range to the records present in the ring */
+    head = log.hdr->head;
+    if (first < log.hdr->tail) {
+        first = log.hdr->tail;
+    }
+    if (last >= head) {
+        last = head - 1;
+    }
+
+    printf("seq,timestamp_ns,channel,raw,voltage\n");
+    for (seq = first; head > 0 && seq <= last; seq++) {
+        if (adc_log_get(&log, seq, &r) < 0) {
+            continue;
+        }
+        if (r.ts_ns < start_ns || r.ts_ns > end_ns) {
+            continue;
+        }
+        printf("%llu,%llu,%u,%u,%f\n",
+               (unsigned long long) seq, (unsigned long long) r.ts_ns,
+               r.channel, r.value, V_REF * r.value / ADC_MAX);
+    }
+
+    adc_log_close(&log);
+    return EXIT_SUCCESS;
+}
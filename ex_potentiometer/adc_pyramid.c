@@ -0,0 +1,229 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_pyramid
+ *
+ *          Incremental multi-resolution min/max/mean pyramid for ADC
+ *          samples. See adc_pyramid.h for an overview.
+ *
+ * \file    adc_pyramid.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "adc_pyramid.h"
+
+/* Bucket widths of the levels, finest first */
+static const int64_t level_width[ADC_PYRAMID_LEVELS] = {
+    ADC_LEVEL_1S, ADC_LEVEL_10S, ADC_LEVEL_1MIN
+};
+
+/*
+ ***************************************************************************
+ * Start of the bucket holding time t on the given level
+ ***************************************************************************
+ */
+static int64_t bucket_start(const struct adc_level *l, int64_t t_ms)
+{
+    return t_ms - (t_ms % l->width_ms);
+}
+
+/*
+ ***************************************************************************
+ * Ring slot of the bucket starting at start_ms
+ ***************************************************************************
+ */
+static struct adc_bucket *bucket_slot(const struct adc_level *l, int64_t start_ms)
+{
+    return (struct adc_bucket *) &l->bucket[(start_ms / l->width_ms) % ADC_PYRAMID_BUCKETS];
+}
+
+/*
+ ***************************************************************************
+ * Merge a bucket into the running query result
+ ***************************************************************************
+ */
+static void stats_merge(struct adc_stats *st, int64_t *sum, const struct adc_bucket *b)
+{
+    if (b->count == 0) {
+        return;
+    }
+    if (st->count == 0 || b->min < st->min) {
+        st->min = b->min;
+    }
+    if (st->count == 0 || b->max > st->max) {
+        st->max = b->max;
+    }
+    st->count += b->count;
+    *sum += b->sum;
+}
+
+/*
+ ***************************************************************************
+ * Reset the pyramid, all buckets are marked unused
+ ***************************************************************************
+ */
+void adc_pyramid_init(struct adc_pyramid *p)
+{
+    int i, j;
+
+    memset(p, 0, sizeof(*p));
+    for (i = 0; i < ADC_PYRAMID_LEVELS; i++) {
+        p->level[i].width_ms = level_width[i];
+        for (j = 0; j < ADC_PYRAMID_BUCKETS; j++) {
+            p->level[i].bucket[j].start_ms = -1;
+        }
+    }
+}
+
+/*
+ ***************************************************************************
+ * Add one sample. Only the current bucket of each level is touched, a
+ * bucket that still holds data of an older period is recycled in place.
+ ***************************************************************************
+ */
+void adc_pyramid_add(struct adc_pyramid *p, int64_t t_ms, int32_t value)
+{
+    struct adc_level  *l;
+    struct adc_bucket *b;
+    int64_t start;
+    int i;
+
+    for (i = 0; i < ADC_PYRAMID_LEVELS; i++) {
+        l = &p->level[i];
+        start = bucket_start(l, t_ms);
+        b = bucket_slot(l, start);
+
+        if (b->start_ms != start) {
+            b->start_ms = start;
+            b->sum      = 0;
+            b->count    = 0;
+            b->min      = value;
+            b->max      = value;
+        }
+        if (value < b->min) {
+            b->min = value;
+        }
+        if (value > b->max) {
+            b->max = value;
+        }
+        b->sum += value;
+        b->count++;
+    }
+
+    if (t_ms > p->last_ms) {
+        p->last_ms = t_ms;
+    }
+}
+
+/*
+ ***************************************************************************
+ * Statistics over [from_ms, to_ms). The finest level that still retains
+ * from_ms answers the query, so at most ADC_PYRAMID_BUCKETS buckets are
+ * merged. The window is widened to the bucket boundaries of that level.
+ * Returns 0 on success, -1 if the window holds no samples.
+ ***************************************************************************
+ */
+int adc_pyramid_query(const struct adc_pyramid *p, int64_t from_ms, int64_t to_ms, struct adc_stats *st)
+{
+    const struct adc_level  *l = NULL;
+    const struct adc_bucket *b;
+    int64_t oldest, start, sum = 0;
+    int i;
+
+    if (to_ms > p->last_ms + 1) {
+        to_ms = p->last_ms + 1;
+    }
+
+    /* Pick the finest level still covering the start of the window */
+    for (i = 0; i < ADC_PYRAMID_LEVELS; i++) {
+        l = &p->level[i];
+        oldest = bucket_start(l, p->last_ms) - (ADC_PYRAMID_BUCKETS - 1) * l->width_ms;
+        if (oldest <= from_ms) {
+            break;
+        }
+    }
+    if (from_ms < oldest) {
+        from_ms = oldest;
+    }
+    if (from_ms < 0) {
+        from_ms = 0;
+    }
+
+    memset(st, 0, sizeof(*st));
+    st->from_ms = bucket_start(l, from_ms);
+    st->to_ms   = st->from_ms;
+
+    for (start = st->from_ms; start < to_ms; start += l->width_ms) {
+        b = bucket_slot(l, start);
+        if (b->start_ms == start) {
+            stats_merge(st, &sum, b);
+        }
+        st->to_ms = start + l->width_ms;
+    }
+
+    if (st->count == 0) {
+        return -1;
+    }
+    st->mean = (double) sum / st->count;
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Statistics over the last width_ms milliseconds
+ ***************************************************************************
+ */
+int adc_pyramid_window(const struct adc_pyramid *p, int64_t width_ms, struct adc_stats *st)
+{
+    return adc_pyramid_query(p, p->last_ms - width_ms + 1, p->last_ms + 1, st);
+}
+
+/*
+ ***************************************************************************
+ * Statistics of a single bucket, age 0 being the current one. This is
+ * what a 1 s, 10 s or 1 min view plots point by point.
+ ***************************************************************************
+ */
+int adc_pyramid_bucket(const struct adc_pyramid *p, int level, int age, struct adc_stats *st)
+{
+    const struct adc_level  *l;
+    const struct adc_bucket *b;
+    int64_t start, sum = 0;
+
+    memset(st, 0, sizeof(*st));
+    if (level < 0 || level >= ADC_PYRAMID_LEVELS || age < 0 || age >= ADC_PYRAMID_BUCKETS) {
+        return -1;
+    }
+
+    l = &p->level[level];
+    start = bucket_start(l, p->last_ms) - age * l->width_ms;
+    if (start < 0) {
+        return -1;
+    }
+    b = bucket_slot(l, start);
+
+    st->from_ms = start;
+    st->to_ms   = start + l->width_ms;
+    if (b->start_ms != start || b->count == 0) {
+        return -1;
+    }
+    stats_merge(st, &sum, b);
+    st->mean = (double) sum / st->count;
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_pyramid
+ *
+ *          Incremental multi-resolution min/max/mean pyramid for ADC
+ *          samples. Every level keeps a ring of fixed-width time buckets
+ *          (1 s, 10 s and 1 min). A new sample updates the current bucket
+ *          of each level, so the work per sample is constant. Window
+ *          queries merge whole buckets and never touch raw samples.
+ *
+ * \file    adc_pyramid.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef ADC_PYRAMID_H
+#define ADC_PYRAMID_H
+
+#include <stdint.h>
+
+/* Number of levels and buckets kept per level */
+#define ADC_PYRAMID_LEVELS	3
+#define ADC_PYRAMID_BUCKETS	60
+
+/* Bucket widths of the levels in ms */
+#define ADC_LEVEL_1S		1000
+#define ADC_LEVEL_10S		10000
+#define ADC_LEVEL_1MIN		60000
+
+/* One time bucket of a level */
+struct adc_bucket {
+    int64_t  start_ms;		/* Start of the bucket, -1 if unused */
+    int64_t  sum;		/* Sum of all samples in the bucket */
+    uint32_t count;		/* Number of samples in the bucket */
+    int32_t  min;
+    int32_t  max;
+};
+
+/* One resolution level of the pyramid */
+struct adc_level {
+    int64_t           width_ms;
+    struct adc_bucket bucket[ADC_PYRAMID_BUCKETS];
+};
+
+/* The pyramid itself */
+struct adc_pyramid {
+    int64_t          last_ms;	/* Timestamp of the newest sample */
+    struct adc_level level[ADC_PYRAMID_LEVELS];
+};
+
+/* Result of a query */
+struct adc_stats {
+    int64_t  from_ms;		/* Effective window, aligned to buckets */
+    int64_t  to_ms;
+    uint32_t count;
+    int32_t  min;
+    int32_t  max;
+    double   mean;
+};
+
+/* Prototypes */
+void adc_pyramid_init(struct adc_pyramid *p);
+void adc_pyramid_add(struct adc_pyramid *p, int64_t t_ms, int32_t value);
+int  adc_pyramid_query(const struct adc_pyramid *p, int64_t from_ms, int64_t to_ms, struct adc_stats *st);
+int  adc_pyramid_window(const struct adc_pyramid *p, int64_t width_ms, struct adc_stats *st);
+int  adc_pyramid_bucket(const struct adc_pyramid *p, int level, int age, struct adc_stats *st);
+
+#endif /* ADC_PYRAMID_H */
@@ -0,0 +1,386 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_ringlog
+ *
+ *          Binary ring log for ADC samples. See adc_ringlog.h for the
+ *          file layout and the crash recovery rules.
+ *
+ * \file    adc_ringlog.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Capacity limit, overwrite after a failed rotation
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "adc_ringlog.h"
+
+/*
+ ***************************************************************************
+ * Size of a log file holding capacity records
+ ***************************************************************************
+ */
+static size_t log_size(uint32_t capacity)
+{
+    return ADC_LOG_HDR_SIZE + (size_t) capacity * sizeof(struct adc_log_record);
+}
+
+/*
+ ***************************************************************************
+ * A capacity whose file size fits size_t and off_t, on a 32-bit target
+ * log_size() would wrap and map less than the ring indexes
+ ***************************************************************************
+ */
+static int log_capacity_ok(uint32_t capacity)
+{
+    size_t size;
+
+    if (capacity == 0 || capacity > (SIZE_MAX - ADC_LOG_HDR_SIZE) / sizeof(struct adc_log_record)) {
+        return 0;
+    }
+    size = log_size(capacity);
+    return (off_t) size > 0 && (size_t) (off_t) size == size;
+}
+
+/*
+ ***************************************************************************
+ * Map an open log file and check its header
+ ***************************************************************************
+ */
+static int log_map(struct adc_log *log, size_t size)
+{
+    int prot = log->writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *map;
+
+    map = mmap(NULL, size, prot, MAP_SHARED, log->fd, 0);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    log->map_size = size;
+    log->hdr = map;
+    log->rec = (struct adc_log_record *) ((char *) map + ADC_LOG_HDR_SIZE);
+
+    if (log->hdr->magic != ADC_LOG_MAGIC ||
+        log->hdr->version != ADC_LOG_VERSION ||
+        log->hdr->record_size != sizeof(struct adc_log_record) ||
+        !log_capacity_ok(log->hdr->capacity) ||
+        log_size(log->hdr->capacity) > size) {
+        munmap(map, size);
+        log->hdr = NULL;
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Create and preallocate a new, empty log file continuing at sequence
+ * number first
+ ***************************************************************************
+ */
+static int log_create(struct adc_log *log, uint32_t capacity, uint64_t first, uint32_t generation)
+{
+    struct adc_log_header hdr;
+    size_t size = log_size(capacity);
+
+    log->fd = open(log->path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (log->fd < 0) {
+        return -1;
+    }
+
+    /* Reserve all blocks now, the ring must never fail for lack of space */
+    if (posix_fallocate(log->fd, 0, size) != 0) {
+        if (ftruncate(log->fd, size) < 0) {
+            close(log->fd);
+            return -1;
+        }
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic       = ADC_LOG_MAGIC;
+    hdr.version     = ADC_LOG_VERSION;
+    hdr.record_size = sizeof(struct adc_log_record);
+    hdr.capacity    = capacity;
+    hdr.generation  = generation;
+    hdr.head        = first;
+    hdr.tail        = first;
+    hdr.created_ns  = adc_log_now();
+    if (pwrite(log->fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) || fsync(log->fd) < 0) {
+        close(log->fd);
+        return -1;
+    }
+
+    if (log_map(log, size) < 0) {
+        close(log->fd);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Roll the head marker forward over records written before a crash
+ ***************************************************************************
+ */
+static void log_recover(struct adc_log *log)
+{
+    struct adc_log_header *hdr = log->hdr;
+    uint64_t head = hdr->head;
+    uint32_t n;
+
+    for (n = 0; n < hdr->capacity; n++) {
+        if (log->rec[head % hdr->capacity].seq != (uint32_t) (head + 1)) {
+            break;
+        }
+        head++;
+    }
+    if (head - hdr->tail > hdr->capacity) {
+        hdr->tail = head - hdr->capacity;
+    }
+    hdr->head = head;
+}
+
+/*
+ ***************************************************************************
+ * Move the full file to path.1, shifting older files up to path.keep,
+ * and start a new ring that continues the sequence numbers. On errors
+ * the current file stays mapped under its name.
+ ***************************************************************************
+ */
+static int log_rotate(struct adc_log *log)
+{
+    char from[ADC_LOG_MAX_PATH + 16], to[ADC_LOG_MAX_PATH + 16];
+    struct adc_log next = *log;
+    int err;
+    uint32_t i;
+
+    adc_log_sync(log);
+    for (i = log->keep; i > 1; i--) {
+        snprintf(from, sizeof(from), "%s.%u", log->path, i - 1);
+        snprintf(to, sizeof(to), "%s.%u", log->path, i);
+        rename(from, to);
+    }
+    snprintf(to, sizeof(to), "%s.1", log->path);
+    if (rename(log->path, to) < 0) {
+        return -1;
+    }
+    if (log_create(&next, log->hdr->capacity, log->hdr->head, log->hdr->generation + 1) < 0) {
+        err = errno;
+        rename(to, log->path);
+        errno = err;
+        return -1;
+    }
+
+    munmap(log->hdr, log->map_size);
+    close(log->fd);
+    *log = next;
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Current time in ns, CLOCK_REALTIME
+ ***************************************************************************
+ */
+uint64_t adc_log_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Open a log for writing. An existing log is reused and recovered, its
+ * capacity wins over the requested one. Returns 0 or -1 with errno set.
+ ***************************************************************************
+ */
+int adc_log_open(struct adc_log *log, const char *path, uint32_t capacity, uint32_t keep)
+{
+    struct stat st;
+
+    memset(log, 0, sizeof(*log));
+    log->writable = 1;
+    log->keep = keep;
+    if (!log_capacity_ok(capacity) || strlen(path) >= sizeof(log->path)) {
+        errno = EINVAL;
+        return -1;
+    }
+    strcpy(log->path, path);
+
+    if (stat(path, &st) < 0 || st.st_size == 0) {
+        return log_create(log, capacity, 0, 0);
+    }
+
+    log->fd = open(path, O_RDWR);
+    if (log->fd < 0) {
+        return -1;
+    }
+    if (log_map(log, st.st_size) < 0) {
+        close(log->fd);
+        return -1;
+    }
+    log_recover(log);
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Open a log for reading only
+ ***************************************************************************
+ */
+int adc_log_open_ro(struct adc_log *log, const char *path)
+{
+    struct stat st;
+
+    memset(log, 0, sizeof(*log));
+    snprintf(log->path, sizeof(log->path), "%s", path);
+
+    log->fd = open(path, O_RDONLY);
+    if (log->fd < 0) {
+        return -1;
+    }
+    if (fstat(log->fd, &st) < 0) {
+        close(log->fd);
+        return -1;
+    }
+    if ((size_t) st.st_size < ADC_LOG_HDR_SIZE) {
+        close(log->fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if (log_map(log, st.st_size) < 0) {
+        close(log->fd);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Append one record. The slot is invalidated first and published with
+ * its sequence number last, so a crash or a concurrent reader never
+ * accepts a half written record.
+ ***************************************************************************
+ */
+int adc_log_append(struct adc_log *log, uint64_t ts_ns, uint16_t channel, uint16_t value)
+{
+    struct adc_log_header *hdr = log->hdr;
+    struct adc_log_record *r;
+    uint64_t seq;
+
+    if (!log->writable || hdr == NULL) {
+        errno = EBADF;
+        return -1;
+    }
+
+    seq = hdr->head;
+    if (seq - hdr->tail >= hdr->capacity) {
+        if (log->keep > 0 && log_rotate(log) < 0) {
+            /* Keep logging into this file, overwriting from now on */
+            log->rotate_errno = errno;
+            log->keep = 0;
+        }
+        if (log->keep > 0) {
+            hdr = log->hdr;
+        } else {
+            __atomic_store_n(&hdr->tail, seq - hdr->capacity + 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    r = &log->rec[seq % hdr->capacity];
+    __atomic_store_n(&r->seq, 0, __ATOMIC_RELEASE);
+    r->ts_ns   = ts_ns;
+    r->channel = channel;
+    r->value   = value;
+    __atomic_store_n(&r->seq, (uint32_t) (seq + 1), __ATOMIC_RELEASE);
+    __atomic_store_n(&hdr->head, seq + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Fetch record seq. Returns 0, or -1 if it is outside [tail, head) or was
+ * overwritten while being copied.
+ ***************************************************************************
+ */
+int adc_log_get(const struct adc_log *log, uint64_t seq, struct adc_log_record *r)
+{
+    const struct adc_log_header *hdr = log->hdr;
+    const struct adc_log_record *slot;
+    uint32_t s1, s2;
+
+    if (seq < __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE) ||
+        seq >= __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE)) {
+        return -1;
+    }
+
+    slot = &log->rec[seq % hdr->capacity];
+    s1 = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    *r = *slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    s2 = __atomic_load_n(&slot->seq, __ATOMIC_RELAXED);
+
+    if (s1 != (uint32_t) (seq + 1) || s2 != s1) {
+        return -1;
+    }
+    r->seq = s1;
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Flush the mapping to the storage
+ ***************************************************************************
+ */
+int adc_log_sync(struct adc_log *log)
+{
+    if (log->hdr == NULL || !log->writable) {
+        return 0;
+    }
+    return msync(log->hdr, log->map_size, MS_SYNC);
+}
+
+/*
+ ***************************************************************************
+ * Flush and close the log
+ ***************************************************************************
+ */
+void adc_log_close(struct adc_log *log)
+{
+    if (log->hdr != NULL) {
+        adc_log_sync(log);
+        munmap(log->hdr, log->map_size);
+        log->hdr = NULL;
+    }
+    if (log->fd >= 0) {
+        close(log->fd);
+        log->fd = -1;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_ringlog
+ *
+ *          Binary ring log for ADC samples. Fixed-size timestamped
+ *          records are appended into a preallocated, memory mapped file.
+ *
+ *          File layout:
+ *          +-------------------+---------------------------------------+
+ *          | adc_log_header    | capacity * adc_log_record (the ring)  |
+ *          +-------------------+---------------------------------------+
+ *
+ *          Records are addressed by a 64-bit sequence number, record s
+ *          lives in slot s % capacity and carries the low 32 bits of s+1,
+ *          so an empty or half written slot never validates. The writer
+ *          stores the payload first and the sequence last, then moves
+ *          the head marker. Before a slot is overwritten the tail marker
+ *          is advanced. After a crash adc_log_open() rolls the head
+ *          forward over every slot that already validates.
+ *
+ *          When the ring is full the oldest record is overwritten. With
+ *          keep > 0 the full file is rotated to path.1 .. path.keep and a
+ *          new ring is started instead. If a rotation fails the log stays
+ *          in the current file and overwrites from then on, the error is
+ *          kept in rotate_errno.
+ *
+ *          adc_log_open() refuses capacities whose file would not fit
+ *          size_t or off_t.
+ *
+ * \file    adc_ringlog.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Capacity limit, overwrite after a failed rotation
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef ADC_RINGLOG_H
+#define ADC_RINGLOG_H
+
+#include <stdint.h>
+
+#define ADC_LOG_MAGIC		0x474c4441	/* "ADLG" */
+#define ADC_LOG_VERSION		1
+#define ADC_LOG_HDR_SIZE	64
+#define ADC_LOG_MAX_PATH	256
+
+/* File header, padded to ADC_LOG_HDR_SIZE */
+struct adc_log_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t capacity;		/* Number of record slots */
+    uint32_t generation;	/* Number of rotations before this file */
+    uint64_t head;		/* Sequence number of the next record */
+    uint64_t tail;		/* Sequence number of the oldest record */
+    uint64_t created_ns;	/* Creation time, CLOCK_REALTIME */
+    uint8_t  reserved[ADC_LOG_HDR_SIZE - 40];
+};
+
+/* One sample record, 16 bytes */
+struct adc_log_record {
+    uint64_t ts_ns;		/* Sample time, CLOCK_REALTIME */
+    uint32_t seq;		/* Low 32 bits of sequence number + 1 */
+    uint16_t channel;		/* AIN channel */
+    uint16_t value;		/* Raw adc value */
+};
+
+/* Writer or reader handle */
+struct adc_log {
+    int                    fd;
+    int                    writable;
+    uint32_t               keep;
+    int                    rotate_errno;	/* Failed rotation, 0 if none */
+    size_t                 map_size;
+    struct adc_log_header *hdr;
+    struct adc_log_record *rec;
+    char                   path[ADC_LOG_MAX_PATH];
+};
+
+/* Prototypes */
+int      adc_log_open(struct adc_log *log, const char *path, uint32_t capacity, uint32_t keep);
+int      adc_log_open_ro(struct adc_log *log, const char *path);
+int      adc_log_append(struct adc_log *log, uint64_t ts_ns, uint16_t channel, uint16_t value);
+int      adc_log_get(const struct adc_log *log, uint64_t seq, struct adc_log_record *r);
+int      adc_log_sync(struct adc_log *log);
+void     adc_log_close(struct adc_log *log);
+uint64_t adc_log_now(void);
+
+#endif /* ADC_RINGLOG_H */
@@ -0,0 +1,65 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_sampler
+ *
+ *          Adaptive, change-driven sampling rate for slowly changing ADC
+ *          inputs such as the potentiometer. While the input is stable
+ *          the sampling period backs off to the slow rate. As soon as a
+ *          sample moves more than the threshold away from the reference
+ *          value the fast rate is used again.
+ *
+ * \file    adc_sampler.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <stdint.h>
+
+/* Default configuration */
+#define ADC_SAMPLER_FAST_US	20000		/* 50 Hz while the input moves */
+#define ADC_SAMPLER_SLOW_US	1000000		/* 1 Hz while the input is idle */
+#define ADC_SAMPLER_THRESHOLD	8		/* Movement threshold in counts */
+#define ADC_SAMPLER_HOLD	25		/* Quiet fast samples before backing off */
+
+struct adc_sampler {
+    /* Configuration */
+    uint32_t fast_us;
+    uint32_t slow_us;
+    int32_t  threshold;
+    uint32_t hold;
+
+    /* State */
+    int32_t  ref;		/* Value at the last detected movement */
+    int      have_ref;
+    uint32_t quiet;		/* Consecutive samples without movement */
+    uint32_t period_us;		/* Period until the next sample */
+
+    /* Statistics */
+    uint64_t samples;		/* Samples actually taken */
+    uint64_t moves;		/* Samples that detected movement */
+    uint64_t elapsed_us;	/* Time covered by the taken samples */
+};
+
+/* Prototypes */
+void     adc_sampler_init(struct adc_sampler *s, uint32_t fast_us, uint32_t slow_us, int32_t threshold, uint32_t hold);
+uint32_t adc_sampler_update(struct adc_sampler *s, int32_t value);
+uint64_t adc_sampler_budget(const struct adc_sampler *s);
+uint64_t adc_sampler_saved(const struct adc_sampler *s);
+
+#endif /* ADC_SAMPLER_H */
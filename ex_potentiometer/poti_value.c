@@ -15,6 +15,18 @@
  *          N = No of bits (12-Bits)
  *          Vref = reference voltage (1.8V)
  *
+ *          Every sample is also fed into a min/max/mean pyramid which
+ *          provides the 1 s, 10 s and 1 min views without rescanning.
+ *
+ *          The sampling rate adapts to the input: the fast rate is used
+ *          while the potentiometer moves, the slow rate while it is idle.
+ *          With -l the samples go as binary records into a memory
+ *          mapped ring log instead of the console, see adc_ringlog.h.
+ *          Export them with adc_logdump.
+ *
+ *          Usage: poti_value [-f fast_ms] [-s slow_ms] [-t threshold]
+ *                            [-l logfile [-n records] [-k keep]]
+ *
  * \file    poti_value.c
  * \version 1.0
  * \date    17.01.2016
@@ -22,6 +34,12 @@
  *
  * \remark  Last Modifications:
  * \remark  V1.0, SCHMA5, 17.01.2016   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Added min/max/mean pyramid
+ * \remark  V1.2, SCHMA5, 18.10.2026   Added adaptive sampling rate
+ * \remark  V1.3, SCHMA5, 18.10.2026   Added binary ring log
+ * \remark  V1.4, SCHMA5, 18.10.2026   Range check of -f and -s
+ * \remark  V1.5, SCHMA5, 18.10.2026   Range check of -t
+ * \remark  V1.6, SCHMA5, 18.10.2026   Range check of -n and -k, report log errors
  ***************************************************************************
  *
  * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
@@ -44,16 +62,27 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
 #include <time.h>
 #include <signal.h>
 #include <math.h>
 
 #include <sys/stat.h>
 
+#include "adc_pyramid.h"
+#include "adc_sampler.h"
+#include "adc_ringlog.h"
+
+/* Mount point of sysfs, the ADC path below is relative to it */
+#ifndef SYSFS_ROOT
+#define SYSFS_ROOT		"/sys"
+#endif
+
 /* String to access the ADC4 via sysfs */
-#define AIN4_DEV	"/sys/bus/iio/devices/iio\:device0/in_voltage4_raw"
+#define AIN4_DEV	SYSFS_ROOT "/bus/iio/devices/iio:device0/in_voltage4_raw"
 
 /* Delay value for one second in us */
 #define ONE_SECOND	1000000
@@ -64,12 +93,34 @@
 #define V_REF			1.8
 #define N			pow(2,12)
 
+/* Print the pyramid views every VIEW_PERIOD_MS */
+#define VIEW_PERIOD_MS		10000
+
+/* Longest sampling period accepted by -f and -s */
+#define MAX_PERIOD_MS		60000
+
+/* Channel number and default size of the ring log */
+#define AIN_CHANNEL		4
+#define LOG_RECORDS		65536
+#define MAX_LOG_RECORDS		(1 << 24)	/* 256 MB of records */
+#define MAX_LOG_KEEP		99
+
 /* Vars */
 int   adc_fd;
 int   charRead;
 float aValue;
 char  adcBuffer[BUFFER_SIZE];
 
+/* Aggregated history of the AIN4 samples */
+static struct adc_pyramid pyramid;
+
+/* Adaptive sampling rate control */
+static struct adc_sampler sampler;
+
+/* Binary ring log, used if log_enabled */
+static struct adc_log log_file;
+static int            log_enabled;
+
 /* Singnal handler for CTRL-C */
 void sigint_handler(int sig);
 
@@ -85,13 +136,126 @@ void signal_callback_handler(int signum)
     /* Inform user */
     printf("\nExit via Ctrl-C\n\n");
 
-    /* Close the adc file */
+    /* Report the sample budget saved by the adaptive rate */
+    printf("Samples taken: %llu, at fixed fast rate: %llu, saved: %llu\n",
+           (unsigned long long) sampler.samples,
+           (unsigned long long) adc_sampler_budget(&sampler),
+           (unsigned long long) adc_sampler_saved(&sampler));
+
+    /* Close the adc file and the log */
     close(adc_fd);
+    if (log_enabled) {
+        adc_log_close(&log_file);
+    }
 
     /* Terminate program */
     exit(signum);
 }
 
+/*
+ ***************************************************************************
+ * Monotonic time in milliseconds
+ ***************************************************************************
+ */
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ ***************************************************************************
+ * Sleep for the given number of microseconds
+ ***************************************************************************
+ */
+
+static void sleep_us(uint32_t us)
+{
+    struct timespec req;
+
+    req.tv_sec  = us / ONE_SECOND;
+    req.tv_nsec = (long) (us % ONE_SECOND) * 1000;
+    nanosleep(&req, NULL);
+}
+
+/*
+ ***************************************************************************
+ * Parse an unsigned decimal number, -1 unless min..max
+ ***************************************************************************
+ */
+
+static int parse_uint(const char *arg, unsigned long min, unsigned long max, unsigned long *val)
+{
+    char *end;
+
+    /* strtoul accepts a sign, a negative number would wrap */
+    if (*arg < '0' || *arg > '9') {
+        return -1;
+    }
+    errno = 0;
+    *val  = strtoul(arg, &end, 10);
+    if (errno || *end != '\0' || *val < min || *val > max) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Parse a sampling period in ms to us, -1 unless 1..MAX_PERIOD_MS
+ ***************************************************************************
+ */
+
+static int parse_period(const char *arg, uint32_t *us)
+{
+    char *end;
+    long  ms = strtol(arg, &end, 10);
+
+    if (end == arg || *end != '\0' || ms < 1 || ms > MAX_PERIOD_MS) {
+        return -1;
+    }
+    *us = ms * 1000;
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * Convert a raw adc value to the input voltage
+ ***************************************************************************
+ */
+
+static float raw_to_volt(double raw)
+{
+    return (V_REF * raw) / (N-1);
+}
+
+/*
+ ***************************************************************************
+ * Print the 1 s, 10 s and 1 min views of the pyramid
+ ***************************************************************************
+ */
+
+static void print_views(void)
+{
+    static const char *name[ADC_PYRAMID_LEVELS] = { "1s", "10s", "1min" };
+    static const int64_t width[ADC_PYRAMID_LEVELS] = {
+        ADC_LEVEL_1S, ADC_LEVEL_10S, ADC_LEVEL_1MIN
+    };
+    struct adc_stats st;
+    int i;
+
+    for (i = 0; i < ADC_PYRAMID_LEVELS; i++) {
+        if (adc_pyramid_window(&pyramid, width[i], &st) == 0) {
+            printf("AIN4 %-4s: min %fV mean %fV max %fV (%u samples)\n",
+                   name[i], raw_to_volt(st.min), raw_to_volt(st.mean),
+                   raw_to_volt(st.max), st.count);
+        }
+    }
+}
+
 /*
  ***************************************************************************
  * main
@@ -100,6 +264,66 @@ void signal_callback_handler(int signum)
 
 int main(int argc, char *argv[])
 {
+    int32_t  raw;
+    int64_t  next_view;
+    uint32_t period_us = ONE_SECOND;
+    uint32_t fast_us   = ADC_SAMPLER_FAST_US;
+    uint32_t slow_us   = ADC_SAMPLER_SLOW_US;
+    int32_t  threshold = ADC_SAMPLER_THRESHOLD;
+    uint32_t records   = LOG_RECORDS;
+    uint32_t keep      = 0;
+    char    *log_path  = NULL;
+    unsigned long arg;
+    int      rotate_reported = 0;
+    int      opt;
+
+    /* Parse the sampler and log configuration */
+    while ((opt = getopt(argc, argv, "f:s:t:l:n:k:")) != -1) {
+        switch (opt) {
+        case 'f':
+            if (parse_period(optarg, &fast_us) < 0) {
+                fprintf(stderr, "-f: fast_ms must be 1..%d\n", MAX_PERIOD_MS);
+                goto usage;
+            }
+            break;
+        case 's':
+            if (parse_period(optarg, &slow_us) < 0) {
+                fprintf(stderr, "-s: slow_ms must be 1..%d\n", MAX_PERIOD_MS);
+                goto usage;
+            }
+            break;
+        case 't':
+            if (parse_uint(optarg, 0, (1 << ADC_BIT_RES) - 1, &arg) < 0) {
+                fprintf(stderr, "-t: threshold must be 0..%d\n", (1 << ADC_BIT_RES) - 1);
+                goto usage;
+            }
+            threshold = arg;
+            break;
+        case 'l':
+            log_path = optarg;
+            break;
+        case 'n':
+            if (parse_uint(optarg, 1, MAX_LOG_RECORDS, &arg) < 0) {
+                fprintf(stderr, "-n: records must be 1..%d\n", MAX_LOG_RECORDS);
+                goto usage;
+            }
+            records = arg;
+            break;
+        case 'k':
+            if (parse_uint(optarg, 0, MAX_LOG_KEEP, &arg) < 0) {
+                fprintf(stderr, "-k: keep must be 0..%d\n", MAX_LOG_KEEP);
+                goto usage;
+            }
+            keep = arg;
+            break;
+        default:
+        usage:
+            fprintf(stderr, "Usage: %s [-f fast_ms] [-s slow_ms] [-t threshold] "
+                    "[-l logfile [-n records] [-k keep]]\n", argv[0]);
+            return -1;
+        }
+    }
+
     /* Register signal and signal handler */
     signal(SIGINT, signal_callback_handler);
 
@@ -111,6 +335,19 @@ int main(int argc, char *argv[])
         perror("Error: cannot open adc device!\n");
         return -1;
     }
+    /* Open the ring log */
+    if (log_path != NULL) {
+        if (adc_log_open(&log_file, log_path, records, keep) < 0) {
+            perror(log_path);
+            close(adc_fd);
+            return -1;
+        }
+        log_enabled = 1;
+    }
+
+    adc_pyramid_init(&pyramid);
+    adc_sampler_init(&sampler, fast_us, slow_us, threshold, ADC_SAMPLER_HOLD);
+    next_view = now_ms() + VIEW_PERIOD_MS;
 
     /* Do until CTRL-C */
     while (1) {
@@ -120,16 +357,43 @@ int main(int argc, char *argv[])
             /* Terminate string */
             adcBuffer[charRead] = '\0';
 
-            /* Calculate input voltage */
-            aValue = (float) atoi(adcBuffer);
-            aValue = (V_REF * aValue) / (N-1);
-            sprintf(adcBuffer, "%f", aValue);
-
-            /* Write input voltage to console */
-            printf("AIN4: %sV\n", adcBuffer);
+            raw = atoi(adcBuffer);
             lseek(adc_fd, 0, 0);
+
+            if (log_enabled) {
+                /* Append the raw value to the ring log */
+                if (adc_log_append(&log_file, adc_log_now(), AIN_CHANNEL, raw) < 0) {
+                    perror("Ring log stopped");
+                    adc_log_close(&log_file);
+                    log_enabled = 0;
+                } else if (log_file.rotate_errno != 0 && !rotate_reported) {
+                    fprintf(stderr, "%s: rotation failed (%s), overwriting the oldest records\n",
+                            log_path, strerror(log_file.rotate_errno));
+                    rotate_reported = 1;
+                }
+            } else {
+                /* Calculate input voltage */
+                aValue = raw_to_volt(raw);
+                sprintf(adcBuffer, "%f", aValue);
+
+                /* Write input voltage to console */
+                printf("AIN4: %sV\n", adcBuffer);
+            }
+
+            /* Update the pyramid and show the views now and then */
+            adc_pyramid_add(&pyramid, now_ms(), raw);
+            if (now_ms() >= next_view) {
+                print_views();
+                next_view += VIEW_PERIOD_MS;
+                if (log_enabled) {
+                    adc_log_sync(&log_file);
+                }
+            }
+
+            /* Let the sampler choose the time to the next sample */
+            period_us = adc_sampler_update(&sampler, raw);
         }
-        sleep(1);
+        sleep_us(period_us);
     }
     /* Clean up and exit */
     close(adc_fd);
@@ -0,0 +1,105 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux adc_sampler
+ *
+ *          Adaptive, change-driven sampling rate. See adc_sampler.h for
+ *          an overview.
+ *
+ * \file    adc_sampler.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adc_sampler.h"
+
+/*
+ ***************************************************************************
+ * Setup the sampler, it starts at the fast rate
+ ***************************************************************************
+ */
+void adc_sampler_init(struct adc_sampler *s, uint32_t fast_us, uint32_t slow_us, int32_t threshold, uint32_t hold)
+{
+    memset(s, 0, sizeof(*s));
+
+    if (fast_us == 0) {
+        fast_us = 1;
+    }
+    if (slow_us < fast_us) {
+        slow_us = fast_us;
+    }
+    s->fast_us   = fast_us;
+    s->slow_us   = slow_us;
+    s->threshold = threshold;
+    s->hold      = hold;
+    s->period_us = fast_us;
+}
+
+/*
+ ***************************************************************************
+ * Feed one sample and get the period in us until the next one. Movement
+ * past the threshold switches to the fast rate at once. After hold quiet
+ * samples the period doubles with every further quiet sample until the
+ * slow rate is reached.
+ ***************************************************************************
+ */
+uint32_t adc_sampler_update(struct adc_sampler *s, int32_t value)
+{
+    s->samples++;
+    s->elapsed_us += s->period_us;
+
+    if (!s->have_ref || abs(value - s->ref) > s->threshold) {
+        s->ref       = value;
+        s->have_ref  = 1;
+        s->quiet     = 0;
+        s->period_us = s->fast_us;
+        s->moves++;
+        return s->period_us;
+    }
+
+    if (++s->quiet >= s->hold && s->period_us < s->slow_us) {
+        s->period_us *= 2;
+        if (s->period_us > s->slow_us) {
+            s->period_us = s->slow_us;
+        }
+    }
+    return s->period_us;
+}
+
+/*
+ ***************************************************************************
+ * Samples a fixed sampler at the fast rate would have taken so far
+ ***************************************************************************
+ */
+uint64_t adc_sampler_budget(const struct adc_sampler *s)
+{
+    return s->elapsed_us / s->fast_us;
+}
+
+/*
+ ***************************************************************************
+ * Samples saved compared to sampling at the fast rate all the time
+ ***************************************************************************
+ */
+uint64_t adc_sampler_saved(const struct adc_sampler *s)
+{
+    uint64_t budget = adc_sampler_budget(s);
+
+    return budget > s->samples ? budget - s->samples : 0;
+}
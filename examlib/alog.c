@@ -0,0 +1,543 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux alog
+ *
+ *          Asynchronous lock-free logger. See alog.h for an overview.
+ *
+ *          Each ring has one producer (the thread that claimed it) and one
+ *          consumer (the flusher). The producer publishes a record by
+ *          storing head with release order, the flusher frees it by
+ *          storing tail with release order. SIGEV_THREAD timers run every
+ *          expiry in a new thread, so a ring is handed back by a thread
+ *          key destructor and becomes free once the flusher drained it.
+ *
+ * \file    alog.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Count unregistered format ids apart
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "alog.h"
+
+/* Argument types of a conversion */
+enum alog_type {
+    ALOG_T_INT,
+    ALOG_T_LONG,
+    ALOG_T_LLONG,
+    ALOG_T_SIZE,
+    ALOG_T_DOUBLE,
+    ALOG_T_PTR,
+};
+
+/* Registered format, split in one piece per conversion plus the tail */
+struct alog_fmt {
+    int   nargs;
+    enum alog_type type[ALOG_MAX_ARGS];
+    char *piece[ALOG_MAX_ARGS];	/* Literal text and one conversion */
+    char *tail;			/* Literal text after the last one, unescaped */
+};
+
+/* Binary record */
+struct alog_rec {
+    uint64_t ts_ns;
+    uint16_t id;
+    uint64_t arg[ALOG_MAX_ARGS];
+};
+
+/* Ring states */
+enum { ALOG_FREE, ALOG_OWNED, ALOG_RELEASED };
+
+/* Single producer, single consumer ring */
+struct alog_ring {
+    int      state;
+    int      busy;		/* Producer inside alog() */
+    uint32_t head;		/* Next record to write, producer */
+    uint64_t calls;		/* Statistics, producer */
+    uint64_t drop_full;
+    uint64_t drop_nested;
+    uint64_t timed;
+    uint64_t cost_sum_ns;
+    uint64_t cost_max_ns;
+    uint32_t tail __attribute__((aligned(64)));	/* Next record to read, flusher */
+    uint64_t written;
+    struct alog_rec rec[ALOG_RING_SIZE];
+};
+
+/* Variables */
+static struct alog_fmt  alog_fmts[ALOG_MAX_FMTS];
+static int              alog_nfmts;
+static struct alog_ring alog_rings[ALOG_RINGS];
+static uint64_t         alog_drop_noring;
+static uint64_t         alog_drop_badid;
+
+static __thread struct alog_ring *alog_self;
+static pthread_key_t    alog_key;
+static pthread_once_t   alog_once = PTHREAD_ONCE_INIT;
+
+static pthread_t        alog_thread;
+static FILE            *alog_out;
+static int              alog_stop_req;
+static int              alog_running;
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns
+ ***************************************************************************
+ */
+static uint64_t alog_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Parse one conversion starting after the '%'. Returns its length and the
+ * argument type, or -1 if it is not supported.
+ ***************************************************************************
+ */
+static int alog_parse_conv(const char *p, enum alog_type *type)
+{
+    const char *s = p;
+    int lng = 0, size = 0;
+
+    while (*p && strchr("-+ #0'", *p)) {
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if (*p == 'h') {
+        p += (p[1] == 'h') ? 2 : 1;
+    } else if (*p == 'l') {
+        lng = (p[1] == 'l') ? 2 : 1;
+        p += lng;
+    } else if (*p == 'z' || *p == 'j' || *p == 't') {
+        size = (*p == 'j') ? 2 : 1;
+        p++;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        if (size == 2) {
+            *type = ALOG_T_LLONG;
+        } else if (size == 1) {
+            *type = ALOG_T_SIZE;
+        } else {
+            *type = lng == 2 ? ALOG_T_LLONG : lng == 1 ? ALOG_T_LONG : ALOG_T_INT;
+        }
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        if (size || lng == 2) {
+            return -1;
+        }
+        *type = ALOG_T_DOUBLE;
+        break;
+    case 's': case 'p':
+        if (size || lng) {
+            return -1;
+        }
+        *type = ALOG_T_PTR;
+        break;
+    default:
+        return -1;
+    }
+    return p + 1 - s;
+}
+
+/*
+ ***************************************************************************
+ * Register a format, returns its id or -1. Call before the logging threads
+ * start, the table is not locked.
+ ***************************************************************************
+ */
+int alog_register(const char *fmt)
+{
+    struct alog_fmt *f;
+    const char *start = fmt, *p = fmt;
+    char *t;
+    int len;
+
+    if (alog_nfmts >= ALOG_MAX_FMTS) {
+        return -1;
+    }
+    f = &alog_fmts[alog_nfmts];
+    memset(f, 0, sizeof(*f));
+
+    while (*p) {
+        if (p[0] != '%') {
+            p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        if (f->nargs == ALOG_MAX_ARGS || (len = alog_parse_conv(p + 1, &f->type[f->nargs])) < 0) {
+            goto err;
+        }
+        p += 1 + len;
+        f->piece[f->nargs] = strndup(start, p - start);
+        f->nargs++;
+        start = p;
+    }
+
+    /* The tail is written with fputs, so "%%" becomes "%" here */
+    if ((f->tail = malloc(strlen(start) + 1)) == NULL) {
+        goto err;
+    }
+    for (t = f->tail, p = start; *p; p++) {
+        *t++ = *p;
+        if (p[0] == '%' && p[1] == '%') {
+            p++;
+        }
+    }
+    *t = '\0';
+    return alog_nfmts++;
+
+err:
+    while (f->nargs > 0) {
+        free(f->piece[--f->nargs]);
+    }
+    return -1;
+}
+
+/*
+ ***************************************************************************
+ * Hand the ring back when its thread exits
+ ***************************************************************************
+ */
+static void alog_release(void *arg)
+{
+    struct alog_ring *r = arg;
+
+    __atomic_store_n(&r->state, ALOG_RELEASED, __ATOMIC_RELEASE);
+}
+
+static void alog_key_init(void)
+{
+    pthread_key_create(&alog_key, alog_release);
+}
+
+/*
+ ***************************************************************************
+ * Claim a free ring for the calling thread
+ ***************************************************************************
+ */
+static struct alog_ring *alog_claim(void)
+{
+    struct alog_ring *r;
+    int i, expected;
+
+    pthread_once(&alog_once, alog_key_init);
+    for (i = 0; i < ALOG_RINGS; i++) {
+        r = &alog_rings[i];
+        expected = ALOG_FREE;
+        if (__atomic_compare_exchange_n(&r->state, &expected, ALOG_OWNED, 0,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            alog_self = r;
+            pthread_setspecific(alog_key, r);
+            return r;
+        }
+    }
+    return NULL;
+}
+
+/*
+ ***************************************************************************
+ * Log one record, the arguments must match the registered format
+ ***************************************************************************
+ */
+void alog(int id, ...)
+{
+    struct alog_ring *r = alog_self;
+    const struct alog_fmt *f;
+    struct alog_rec *rec;
+    uint64_t t0 = 0, ns;
+    uint32_t head;
+    va_list ap;
+    double d;
+    int i;
+
+    /* A bad id is a caller bug, not ring pressure */
+    if (id < 0 || id >= alog_nfmts) {
+        __atomic_fetch_add(&alog_drop_badid, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    if (r == NULL && (r = alog_claim()) == NULL) {
+        __atomic_fetch_add(&alog_drop_noring, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    /* A signal handler interrupting alog() on this thread must not touch
+     * the ring */
+    if (r->busy) {
+        r->drop_nested++;
+        return;
+    }
+    r->busy = 1;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+
+    if ((r->calls++ & (ALOG_SAMPLE - 1)) == 0) {
+        t0 = alog_now();
+    }
+
+    head = r->head;
+    if (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) >= ALOG_RING_SIZE) {
+        r->drop_full++;
+        goto out;
+    }
+
+    f   = &alog_fmts[id];
+    rec = &r->rec[head & (ALOG_RING_SIZE - 1)];
+    rec->ts_ns = t0 ? t0 : alog_now();
+    rec->id    = id;
+
+    va_start(ap, id);
+    for (i = 0; i < f->nargs; i++) {
+        switch (f->type[i]) {
+        case ALOG_T_INT:
+            rec->arg[i] = (uint64_t) va_arg(ap, int);
+            break;
+        case ALOG_T_LONG:
+            rec->arg[i] = (uint64_t) va_arg(ap, long);
+            break;
+        case ALOG_T_LLONG:
+            rec->arg[i] = (uint64_t) va_arg(ap, long long);
+            break;
+        case ALOG_T_SIZE:
+            rec->arg[i] = (uint64_t) va_arg(ap, size_t);
+            break;
+        case ALOG_T_DOUBLE:
+            d = va_arg(ap, double);
+            memcpy(&rec->arg[i], &d, sizeof(d));
+            break;
+        case ALOG_T_PTR:
+            rec->arg[i] = (uintptr_t) va_arg(ap, void *);
+            break;
+        }
+    }
+    va_end(ap);
+
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+
+out:
+    if (t0) {
+        ns = alog_now() - t0;
+        r->timed++;
+        r->cost_sum_ns += ns;
+        if (ns > r->cost_max_ns) {
+            r->cost_max_ns = ns;
+        }
+    }
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    r->busy = 0;
+}
+
+/*
+ ***************************************************************************
+ * Format one record into the output
+ ***************************************************************************
+ */
+static void alog_format(FILE *out, const struct alog_rec *rec)
+{
+    const struct alog_fmt *f = &alog_fmts[rec->id];
+    double d;
+    int i;
+
+    for (i = 0; i < f->nargs; i++) {
+        switch (f->type[i]) {
+        case ALOG_T_INT:
+            fprintf(out, f->piece[i], (int) rec->arg[i]);
+            break;
+        case ALOG_T_LONG:
+            fprintf(out, f->piece[i], (long) rec->arg[i]);
+            break;
+        case ALOG_T_LLONG:
+            fprintf(out, f->piece[i], (long long) rec->arg[i]);
+            break;
+        case ALOG_T_SIZE:
+            fprintf(out, f->piece[i], (size_t) rec->arg[i]);
+            break;
+        case ALOG_T_DOUBLE:
+            memcpy(&d, &rec->arg[i], sizeof(d));
+            fprintf(out, f->piece[i], d);
+            break;
+        case ALOG_T_PTR:
+            fprintf(out, f->piece[i], (void *) (uintptr_t) rec->arg[i]);
+            break;
+        }
+    }
+    fputs(f->tail, out);
+}
+
+/*
+ ***************************************************************************
+ * Write all records stored so far, merged over the rings by timestamp.
+ * Drained rings of exited threads become free again.
+ ***************************************************************************
+ */
+static void alog_drain(FILE *out)
+{
+    uint32_t head[ALOG_RINGS];
+    int state[ALOG_RINGS];
+    struct alog_ring *r;
+    const struct alog_rec *rec, *best;
+    int i, b;
+
+    for (i = 0; i < ALOG_RINGS; i++) {
+        state[i] = __atomic_load_n(&alog_rings[i].state, __ATOMIC_ACQUIRE);
+        head[i]  = __atomic_load_n(&alog_rings[i].head, __ATOMIC_ACQUIRE);
+    }
+
+    for (;;) {
+        best = NULL;
+        b = -1;
+        for (i = 0; i < ALOG_RINGS; i++) {
+            r = &alog_rings[i];
+            if (r->tail == head[i]) {
+                continue;
+            }
+            rec = &r->rec[r->tail & (ALOG_RING_SIZE - 1)];
+            if (best == NULL || rec->ts_ns < best->ts_ns) {
+                best = rec;
+                b = i;
+            }
+        }
+        if (best == NULL) {
+            break;
+        }
+        alog_format(out, best);
+        r = &alog_rings[b];
+        r->written++;
+        __atomic_store_n(&r->tail, r->tail + 1, __ATOMIC_RELEASE);
+    }
+    fflush(out);
+
+    for (i = 0; i < ALOG_RINGS; i++) {
+        r = &alog_rings[i];
+        if (state[i] == ALOG_RELEASED && r->tail == head[i]) {
+            r->busy = 0;
+            __atomic_store_n(&r->state, ALOG_FREE, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+/*
+ ***************************************************************************
+ * Flusher thread
+ ***************************************************************************
+ */
+static void *alog_flusher(void *arg)
+{
+    struct timespec period;
+
+    period.tv_sec  = 0;
+    period.tv_nsec = ALOG_FLUSH_MS * 1000000L;
+
+    while (!__atomic_load_n(&alog_stop_req, __ATOMIC_ACQUIRE)) {
+        alog_drain(alog_out);
+        nanosleep(&period, NULL);
+    }
+    alog_drain(alog_out);
+    return NULL;
+}
+
+/*
+ ***************************************************************************
+ * Start and stop the flusher, alog_stop writes the remaining records
+ ***************************************************************************
+ */
+int alog_start(FILE *out)
+{
+    alog_out      = out;
+    alog_stop_req = 0;
+    if (pthread_create(&alog_thread, NULL, alog_flusher, NULL) != 0) {
+        return -1;
+    }
+    alog_running = 1;
+    return 0;
+}
+
+void alog_stop(void)
+{
+    if (!alog_running) {
+        return;
+    }
+    __atomic_store_n(&alog_stop_req, 1, __ATOMIC_RELEASE);
+    pthread_join(alog_thread, NULL);
+    alog_running = 0;
+}
+
+/*
+ ***************************************************************************
+ * Statistics
+ ***************************************************************************
+ */
+void alog_get_stats(struct alog_stats *st)
+{
+    const struct alog_ring *r;
+    int i;
+
+    memset(st, 0, sizeof(*st));
+    st->drop_noring = __atomic_load_n(&alog_drop_noring, __ATOMIC_RELAXED);
+    st->drop_badid  = __atomic_load_n(&alog_drop_badid, __ATOMIC_RELAXED);
+    for (i = 0; i < ALOG_RINGS; i++) {
+        r = &alog_rings[i];
+        st->records     += __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+        st->written     += r->written;
+        st->drop_full   += r->drop_full;
+        st->drop_nested += r->drop_nested;
+        st->timed       += r->timed;
+        st->cost_sum_ns += r->cost_sum_ns;
+        if (r->cost_max_ns > st->cost_max_ns) {
+            st->cost_max_ns = r->cost_max_ns;
+        }
+    }
+}
+
+void alog_report(FILE *out)
+{
+    struct alog_stats st;
+
+    alog_get_stats(&st);
+    fprintf(out, "alog: %llu records, %llu written, dropped %llu (ring full %llu, "
+            "no ring %llu, nested %llu, bad id %llu)\n",
+            (unsigned long long) st.records, (unsigned long long) st.written,
+            (unsigned long long) (st.drop_full + st.drop_noring + st.drop_nested + st.drop_badid),
+            (unsigned long long) st.drop_full, (unsigned long long) st.drop_noring,
+            (unsigned long long) st.drop_nested, (unsigned long long) st.drop_badid);
+    if (st.timed) {
+        fprintf(out, "alog: %.0f ns per call, max %llu ns (%llu calls timed)\n",
+                (double) st.cost_sum_ns / st.timed,
+                (unsigned long long) st.cost_max_ns, (unsigned long long) st.timed);
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux alog
+ *
+ *          Asynchronous logger for timer callbacks and other hot paths.
+ *          A log call does not format anything and takes no lock: it
+ *          stores the format id, a timestamp and the raw arguments as one
+ *          binary record in a single producer ring owned by the calling
+ *          thread. A background thread merges the rings in timestamp
+ *          order, formats the records and writes them out.
+ *
+ *          Formats are registered once at startup with alog_register(),
+ *          they may hold up to ALOG_MAX_ARGS conversions of integer,
+ *          floating point or pointer type (%s only for string constants,
+ *          no '*' width or precision).
+ *
+ *          A record is dropped, never waited for, if the ring is full, no
+ *          ring is free or a signal handler logs while its thread is inside
+ *          alog(). Calls with an unregistered format id are counted apart.
+ *          Every ALOG_SAMPLE-th call per ring is timed to report
+ *          the cost of a log call.
+ *
+ * \file    alog.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Count unregistered format ids apart
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef ALOG_H
+#define ALOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Configuration */
+#define ALOG_MAX_ARGS		4	/* Conversions per format */
+#define ALOG_MAX_FMTS		64	/* Registered formats */
+#define ALOG_RINGS		32	/* Threads logging at the same time */
+#define ALOG_RING_SIZE		256	/* Records per ring, power of 2 */
+#define ALOG_FLUSH_MS		20	/* Flusher period */
+#define ALOG_SAMPLE		64	/* Time one call in ALOG_SAMPLE */
+
+/* Counters summed over all rings */
+struct alog_stats {
+    uint64_t records;		/* Records stored */
+    uint64_t written;		/* Records formatted and written */
+    uint64_t drop_full;		/* Ring full */
+    uint64_t drop_noring;	/* No free ring for the thread */
+    uint64_t drop_nested;	/* Signal handler inside alog() */
+    uint64_t drop_badid;	/* Format id not registered */
+    uint64_t timed;		/* Sampled calls */
+    uint64_t cost_sum_ns;	/* Time of the sampled calls */
+    uint64_t cost_max_ns;
+};
+
+/* Prototypes */
+int  alog_register(const char *fmt);
+void alog(int id, ...);
+int  alog_start(FILE *out);
+void alog_stop(void);
+void alog_get_stats(struct alog_stats *st);
+void alog_report(FILE *out);
+
+#endif /* ALOG_H */
@@ -0,0 +1,190 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux evtrace
+ *
+ *          Flight recorder for GPIO, timer and ADC events. See evtrace.h
+ *          for an overview.
+ *
+ * \file    evtrace.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/syscall.h>
+
+#include "evtrace.h"
+
+/* GPIO numbers with edge detection */
+#define EVTRACE_GPIOS		256
+
+/* The ring and the index of the next slot */
+static struct evtrace_event evtrace_ring[EVTRACE_EVENTS];
+static uint64_t             evtrace_index;
+
+/* Last value read per GPIO, -1 = unknown */
+static int8_t evtrace_last[EVTRACE_GPIOS] = { [0 ... EVTRACE_GPIOS - 1] = -1 };
+
+static __thread uint32_t evtrace_tid;
+
+static const char *evtrace_names[EVT_TYPE_COUNT] = {
+    [EVT_GPIO_EXPORT]        = "gpio_export",
+    [EVT_GPIO_UNEXPORT]      = "gpio_unexport",
+    [EVT_GPIO_SET_DIRECTION] = "gpio_set_direction",
+    [EVT_GPIO_GET_VALUE]     = "gpio_get_value",
+    [EVT_GPIO_SET_VALUE]     = "gpio_set_value",
+    [EVT_GPIO_EDGE]          = "gpio_edge",
+    [EVT_TIMER_INIT]         = "timer_init",
+    [EVT_TIMER_EXPIRY]       = "timer_expiry",
+    [EVT_ADC_SAMPLE]         = "adc_sample",
+};
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns, use it for the t0 passed to evtrace_add()
+ ***************************************************************************
+ */
+uint64_t evtrace_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+const char *evtrace_name(unsigned type)
+{
+    if (type >= EVT_TYPE_COUNT || evtrace_names[type] == NULL) {
+        return "unknown";
+    }
+    return evtrace_names[type];
+}
+
+/*
+ ***************************************************************************
+ * Store one event in the next slot
+ ***************************************************************************
+ */
+static void evtrace_put(enum evtrace_type type, uint32_t id, int32_t value,
+                        uint64_t ts, uint64_t dur, int failed)
+{
+    struct evtrace_event *ev;
+    uint64_t idx;
+
+    if (evtrace_tid == 0) {
+        evtrace_tid = (uint32_t) syscall(SYS_gettid);
+    }
+
+    idx = __atomic_fetch_add(&evtrace_index, 1, __ATOMIC_RELAXED);
+    ev  = &evtrace_ring[idx & (EVTRACE_EVENTS - 1)];
+
+    /* Invalidate the slot while it is rewritten */
+    __atomic_store_n(&ev->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ev->ts_ns    = ts;
+    ev->tid      = evtrace_tid;
+    ev->type     = type;
+    ev->flags    = failed ? EVT_F_ERROR : 0;
+    ev->reserved = 0;
+    ev->id       = id;
+    ev->value    = value;
+    ev->dur_ns   = dur > UINT32_MAX ? UINT32_MAX : (uint32_t) dur;
+    __atomic_store_n(&ev->seq, (uint32_t) (idx + 1), __ATOMIC_RELEASE);
+}
+
+/*
+ ***************************************************************************
+ * Record an operation that started at t0 and ends now. t0 = 0 records an
+ * instant event. A GET_VALUE that differs from the last value read on the
+ * same GPIO adds an EDGE event.
+ ***************************************************************************
+ */
+void evtrace_add(enum evtrace_type type, uint32_t id, int32_t value, uint64_t t0, int failed)
+{
+    uint64_t now = evtrace_now();
+    int8_t last;
+
+    evtrace_put(type, id, value, t0 ? t0 : now, t0 ? now - t0 : 0, failed);
+
+    if (type != EVT_GPIO_GET_VALUE || failed || id >= EVTRACE_GPIOS) {
+        return;
+    }
+    last = __atomic_exchange_n(&evtrace_last[id], (int8_t) value, __ATOMIC_RELAXED);
+    if (last >= 0 && last != value) {
+        evtrace_put(EVT_GPIO_EDGE, id, value, now, 0, 0);
+    }
+}
+
+/*
+ ***************************************************************************
+ * Write the ring, oldest event first, into a dump file. Slots that are
+ * being rewritten during the dump are skipped.
+ ***************************************************************************
+ */
+int evtrace_dump(const char *path)
+{
+    struct evtrace_header hdr;
+    struct evtrace_event *buf, *ev;
+    uint64_t end, start, i;
+    uint32_t n = 0;
+    FILE *f;
+    int ret = 0;
+
+    if ((buf = malloc(sizeof(*buf) * EVTRACE_EVENTS)) == NULL) {
+        return -1;
+    }
+
+    end   = __atomic_load_n(&evtrace_index, __ATOMIC_ACQUIRE);
+    start = end > EVTRACE_EVENTS ? end - EVTRACE_EVENTS : 0;
+    for (i = start; i < end; i++) {
+        ev = &evtrace_ring[i & (EVTRACE_EVENTS - 1)];
+        if (__atomic_load_n(&ev->seq, __ATOMIC_ACQUIRE) != (uint32_t) (i + 1)) {
+            continue;
+        }
+        buf[n] = *ev;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&ev->seq, __ATOMIC_RELAXED) == (uint32_t) (i + 1)) {
+            n++;
+        }
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic      = EVTRACE_MAGIC;
+    hdr.version    = EVTRACE_VERSION;
+    hdr.event_size = sizeof(struct evtrace_event);
+    hdr.count      = n;
+    hdr.lost       = start;
+
+    if ((f = fopen(path, "wb")) == NULL) {
+        free(buf);
+        return -1;
+    }
+    if (fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+        (n && fwrite(buf, sizeof(*buf), n, f) != n)) {
+        ret = -1;
+    }
+    if (fclose(f) != 0) {
+        ret = -1;
+    }
+    free(buf);
+    return ret < 0 ? ret : (int) n;
+}
@@ -0,0 +1,100 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux evtrace
+ *
+ *          Flight recorder for GPIO, timer and ADC activity. Every event
+ *          is a fixed-size binary record with a CLOCK_MONOTONIC timestamp,
+ *          the thread id, the event type, the GPIO or timer number, a value
+ *          and the duration of the operation. The events go into one
+ *          in-memory ring shared by all threads; when it is full the oldest
+ *          events are overwritten.
+ *
+ *          Writers take a slot with an atomic increment of the ring index
+ *          and store the sequence number of the slot last, so the dump can
+ *          skip slots that are being written. evtrace_dump() writes the
+ *          ring oldest first into a file:
+ *
+ *          +-----------------+-------------------------------+
+ *          | evtrace_header  | count * struct evtrace_event  |
+ *          +-----------------+-------------------------------+
+ *
+ *          evtrace_json turns such a dump into Chrome trace JSON for
+ *          chrome://tracing or Perfetto.
+ *
+ * \file    evtrace.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef EVTRACE_H
+#define EVTRACE_H
+
+#include <stdint.h>
+
+/* Ring size in events, power of 2 */
+#define EVTRACE_EVENTS		4096
+
+/* Dump file identification */
+#define EVTRACE_MAGIC		0x52545645	/* "EVTR" */
+#define EVTRACE_VERSION		1
+
+/* Event types */
+enum evtrace_type {
+    EVT_GPIO_EXPORT = 1,
+    EVT_GPIO_UNEXPORT,
+    EVT_GPIO_SET_DIRECTION,
+    EVT_GPIO_GET_VALUE,
+    EVT_GPIO_SET_VALUE,
+    EVT_GPIO_EDGE,		/* GET_VALUE saw another value than before */
+    EVT_TIMER_INIT,		/* value = period in us */
+    EVT_TIMER_EXPIRY,		/* duration = run time of the callback */
+    EVT_ADC_SAMPLE,		/* value = raw sample */
+    EVT_TYPE_COUNT
+};
+
+/* Event flags */
+#define EVT_F_ERROR		0x01	/* The operation failed */
+
+/* One event, 32 bytes */
+struct evtrace_event {
+    uint64_t ts_ns;		/* CLOCK_MONOTONIC at the start */
+    uint32_t seq;		/* Low 32 bits of the ring index + 1 */
+    uint32_t tid;		/* Thread id */
+    uint16_t type;		/* enum evtrace_type */
+    uint8_t  flags;
+    uint8_t  reserved;
+    uint32_t id;		/* GPIO number or timer index */
+    int32_t  value;
+    uint32_t dur_ns;		/* Duration, 0 for instant events */
+};
+
+/* Dump file header */
+struct evtrace_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t event_size;
+    uint32_t count;		/* Events following the header */
+    uint32_t reserved;
+    uint64_t lost;		/* Events overwritten before the dump */
+};
+
+/* Prototypes */
+uint64_t evtrace_now(void);
+void     evtrace_add(enum evtrace_type type, uint32_t id, int32_t value, uint64_t t0, int failed);
+int      evtrace_dump(const char *path);
+const char *evtrace_name(unsigned type);
+
+#endif /* EVTRACE_H */
@@ -0,0 +1,169 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux evtrace_json
+ *
+ *          Decoder for evtrace dumps. Writes the events as Chrome trace
+ *          JSON (Trace Event Format) to stdout or a file, to be opened with
+ *          chrome://tracing or https://ui.perfetto.dev:
+ *
+ *          - operations with a duration become complete events ("X")
+ *          - edges and timer setups become instant events ("i")
+ *          - ADC samples also feed a counter track ("C")
+ *
+ *          Times are relative to the earliest event, one track per thread.
+ *          Events are stored when they complete but stamped with their
+ *          start, so the earliest one need not be the first in the dump.
+ *
+ *          Usage: evtrace_json dumpfile [jsonfile]
+ *
+ * \file    evtrace_json.c
+ * \version 1.1
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Times relative to the earliest event
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "evtrace.h"
+
+/* Process id shown in the viewer */
+#define TRACE_PID		1
+
+/*
+ ***************************************************************************
+ * Category and argument name of an event type
+ ***************************************************************************
+ */
+static const char *event_cat(unsigned type)
+{
+    switch (type) {
+    case EVT_TIMER_INIT:
+    case EVT_TIMER_EXPIRY:
+        return "timer";
+    case EVT_ADC_SAMPLE:
+        return "adc";
+    default:
+        return "gpio";
+    }
+}
+
+static const char *event_id_name(unsigned type)
+{
+    switch (type) {
+    case EVT_TIMER_INIT:
+    case EVT_TIMER_EXPIRY:
+        return "timer";
+    case EVT_ADC_SAMPLE:
+        return "channel";
+    default:
+        return "gpio";
+    }
+}
+
+/*
+ ***************************************************************************
+ * Write one event, t0 is the time of the earliest event
+ ***************************************************************************
+ */
+static void write_event(FILE *out, const struct evtrace_event *ev, uint64_t t0, int first)
+{
+    double ts = (ev->ts_ns - t0) / 1000.0;
+
+    fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,",
+            first ? "" : ",", evtrace_name(ev->type), event_cat(ev->type),
+            TRACE_PID, ev->tid, ts);
+    if (ev->dur_ns) {
+        fprintf(out, "\"ph\":\"X\",\"dur\":%.3f,", ev->dur_ns / 1000.0);
+    } else {
+        fprintf(out, "\"ph\":\"i\",\"s\":\"t\",");
+    }
+    fprintf(out, "\"args\":{\"%s\":%u,\"value\":%d,\"error\":%s}}",
+            event_id_name(ev->type), ev->id, ev->value,
+            (ev->flags & EVT_F_ERROR) ? "true" : "false");
+
+    /* The ADC samples also as a counter track */
+    if (ev->type == EVT_ADC_SAMPLE && !(ev->flags & EVT_F_ERROR)) {
+        fprintf(out, ",\n{\"name\":\"AIN%u\",\"ph\":\"C\",\"pid\":%d,\"ts\":%.3f,"
+                "\"args\":{\"raw\":%d}}", ev->id, TRACE_PID, ts, ev->value);
+    }
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    struct evtrace_header hdr;
+    struct evtrace_event ev;
+    uint64_t t0 = 0;
+    uint32_t i, errors = 0;
+    FILE *in, *out = stdout;
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s dumpfile [jsonfile]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if ((in = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, in) != 1 || hdr.magic != EVTRACE_MAGIC ||
+        hdr.version != EVTRACE_VERSION || hdr.event_size != sizeof(ev)) {
+        fprintf(stderr, "%s: not an evtrace dump\n", argv[1]);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+    if (argc == 3 && (out = fopen(argv[2], "w")) == NULL) {
+        perror(argv[2]);
+        fclose(in);
+        return EXIT_FAILURE;
+    }
+
+    /* First pass for the earliest start time */
+    for (i = 0; i < hdr.count && fread(&ev, sizeof(ev), 1, in) == 1; i++) {
+        if (i == 0 || ev.ts_ns < t0) {
+            t0 = ev.ts_ns;
+        }
+    }
+    fseek(in, sizeof(hdr), SEEK_SET);
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (i = 0; i < hdr.count && fread(&ev, sizeof(ev), 1, in) == 1; i++) {
+        if (ev.flags & EVT_F_ERROR) {
+            errors++;
+        }
+        write_event(out, &ev, t0, i == 0);
+    }
+    fprintf(out, "\n],\"otherData\":{\"events\":%u,\"lost\":%llu,\"errors\":%u}}\n",
+            i, (unsigned long long) hdr.lost, errors);
+
+    fprintf(stderr, "%u events, %llu overwritten before the dump, %u failed operations\n",
+            i, (unsigned long long) hdr.lost, errors);
+    if (i != hdr.count) {
+        fprintf(stderr, "%s: truncated, %u of %u events\n", argv[1], i, hdr.count);
+    }
+
+    fclose(in);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+}
@@ -15,11 +15,35 @@
  *          N = No of bits (12-Bits)
  *          Vref = reference voltage (1.8V)
  *
+ *          The adc timer adapts its period to the input, see
+ *          ../ex_potentiometer/adc_sampler.h
+ *
+ *          The timer callbacks log through alog (alog.h, a copy of the
+ *          ex_posix_timer one), a background thread formats and prints the
+ *          records. SIGINT and SIGTERM are taken with sigwait() in main,
+ *          not in a handler.
+ *
+ *          GPIO operations, edges, timer expiries and ADC samples are kept
+ *          in the evtrace flight recorder (evtrace.h). SIGUSR2 and the exit
+ *          dump it to EVTRACE_FILE, convert the dump with evtrace_json.
+ *
+ *          sysfs_gpio_handler counts calls, open and I/O errors and keeps
+ *          a latency histogram per action and GPIO line (gpio_stats.h).
+ *          SIGUSR1 prints a snapshot from main, the timers keep running.
+ *
+ *          USDT probes (usdt.h, provider examlib) for bpftrace or perf:
+ *          gpio_op(function, gpio, value, latency_ns, gpio_stats_err),
+ *          timer_entry(timer) / timer_return(timer), adc_sample(channel,
+ *          raw, start_ns), adc_rate(period_us). start_ns is CLOCK_MONOTONIC
+ *          like bpftrace's nsecs.
+ *
  *          LEDs:
  *          -----
  *
  *          Buttons:
  *          --------
+ *          examlib -b polls the buttons every 500 ms (callback_btn) and
+ *          shows them on the LEDs, the blink timers stay off.
  *
  *          Timers:
  *          -------
@@ -31,6 +55,15 @@
  *
  * \remark  Last Modifications:
  * \remark  V1.0, SCHMA5, 17.01.2016   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Adaptive adc sampling rate
+ * \remark  V1.2, SCHMA5, 18.10.2026   Asynchronous logging, exit via sigwait
+ * \remark  V1.3, SCHMA5, 18.10.2026   evtrace flight recorder
+ * \remark  V1.4, SCHMA5, 18.10.2026   GPIO statistics, snapshot on SIGUSR1
+ * \remark  V1.5, SCHMA5, 18.10.2026   USDT probes
+ * \remark  V1.6, SCHMA5, 18.10.2026   Button mode -b
+ * \remark  V1.7, SCHMA5, 18.10.2026   Re-arm the adc timer under the rate lock
+ * \remark  V1.8, SCHMA5, 18.10.2026   sysfs_gpio_handler returns -1 on failed read/write
+ * \remark  V1.9, SCHMA5, 18.10.2026   button[] and led[] sized MAX_GPIO
  ***************************************************************************
  *
  * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
@@ -64,14 +97,26 @@
 #include<string.h>
 #include<stdbool.h>
 #include<errno.h>
+#include<pthread.h>
 #include<sys/time.h>
 #include<sys/stat.h>
 #include<sys/types.h>
 #include<sys/ioctl.h>
 #include<sys/time.h>
 
+#include "adc_sampler.h"
+#include "alog.h"
+#include "evtrace.h"
+#include "gpio_stats.h"
+#include "usdt.h"
+
+/* sysfs mount, prefix of the ADC and GPIO paths */
+#ifndef SYSFS_ROOT
+#define SYSFS_ROOT		"/sys"
+#endif
+
 /* String to access the ADC4 via sysfs */
-#define AIN4_DEV	    "/sys/bus/iio/devices/iio:device0/in_voltage4_raw"
+#define AIN4_DEV	    SYSFS_ROOT "/bus/iio/devices/iio:device0/in_voltage4_raw"
 
 /* Delay value for one second in us */
 #define ONE_SECOND		1000000
@@ -81,14 +126,21 @@
 #define ADC_BIT_RES		12
 #define V_REF			1.8
 #define N				pow(2,12)
+#define AIN_CHANNEL		4
 #undef DEBUG
 
+/* Dump file of the event trace, written on SIGUSR2 and at exit */
+#define EVTRACE_FILE	"examlib.evt"
+
+/* Timers with a traced callback */
+#define MAX_TIMERS		8
+
 /* Delay value in micro seconds */
 #define ONE_MILLISECOND	1000
 #define ONE_SECOND		1000000
 
 /* Define some useful constants */
-#define SYSFS_PATH		"/sys/class/gpio/"
+#define SYSFS_PATH		SYSFS_ROOT "/class/gpio/"
 #define MAX_STR_BUF		512
 #define MAX_PATH_STR	512
 #define LOW		    	0
@@ -132,6 +184,11 @@ enum {
     GPIO_SYSFS_SET_VALUE,
 } GPIO_ACTIONS;
 
+/* Names of the actions in the statistics */
+static const char *const gpio_action_name[GPIO_STATS_ACTIONS] = {
+    "EXPORT", "UNEXPORT", "GET_DIRECTION", "SET_DIRECTION", "GET_VALUE", "SET_VALUE"
+};
+
 /* Static variables */
 static int32_t gpio_led[MAX_GPIO] = {LED_1, LED_2, LED_3, LED_4};
 static int32_t gpio_btn[MAX_GPIO] = {BUTN_1, BUTN_2, BUTN_3, BUTN_4};
@@ -142,12 +199,25 @@ static char IN[]  = "in";
 
 /* Other variables */
 char  	adcBuffer[BUFFER_SIZE];
-char   	button[3];
-char   	led[3];
+char   	button[MAX_GPIO];
+char   	led[MAX_GPIO];
 time_t 	timerid_1, timerid_2, timerid_3, timerid_4, timerid_adc, timerid_btn;
 struct 	sigevent se_timer1, se_timer2, se_timer3, se_timer4, se_timer_adc, se_timer_btn;
 struct 	itimerspec ts_1, ts_2, ts_3, ts_4, ts_adc, ts_btn;
 volatile int32_t counter1, counter2, counter3, counter4 = 0;
+struct  adc_sampler adc_rate;
+
+/* Log formats */
+static int fmt_adc;
+
+/* Traced timers, the timer thread enters timer_trampoline() */
+struct timer_slot {
+    void      (*callback)(union sigval arg);
+    union sigval arg;
+    uint32_t    index;
+};
+static struct timer_slot timer_slots[MAX_TIMERS];
+static uint32_t          timer_count;
 
 /* Prototypes */
 void callback_1(union sigval arg);
@@ -158,10 +228,13 @@ void callback_adc(union sigval arg);
 void callback_btn(union sigval arg);
 void init_timer(void (*callback)(union sigval arg), struct sigevent *se, struct itimerspec *ts, time_t *timerid, int nanoseconds, int seconds);
 void start_timer(struct itimerspec *ts, time_t *timerid);
-void signal_ctrlc_handler(int signum);
-void signal_terminate_handler(int signum);
+void exit_cleanup(int signum);
+void dump_trace(void);
 int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val);
+int32_t read_adc_raw(void);
 float read_adc_value(void); 
+uint32_t adc_rate_update(int32_t raw, bool *changed);
+void report_adc_rate(void);
 
 /* Timer1 callback */
 void callback_1(union sigval arg)
@@ -226,9 +299,22 @@ void callback_4(union sigval arg)
 /* ADC_Timer callback */
 void callback_adc(union sigval arg)
 {
-	float aValue = read_adc_value();
-	sprintf(adcBuffer, "%f", aValue);
-	printf("AIN4: %sV\n", adcBuffer);	// Write output to console
+	int32_t  raw = read_adc_raw();
+	uint32_t period;
+	bool     changed;
+
+	if (raw < 0) {
+		return;
+	}
+
+	float aValue = (V_REF * raw) / ((1<<12)-1);
+	alog(fmt_adc, aValue);				// Logged, printed by the alog thread
+
+	/* Feed the sampler, it re-arms the timer on another rate */
+	period = adc_rate_update(raw, &changed);
+	if (changed) {
+		USDT1(examlib, adc_rate, period);
+	}
 }
 
 /* Button polling timer callback */
@@ -251,6 +337,18 @@ void callback_btn(union sigval arg)
 	} 
 }
 
+/* Run a timer callback and trace the expiry with its run time */
+static void timer_trampoline(union sigval arg)
+{
+    struct timer_slot *slot = arg.sival_ptr;
+    uint64_t t0 = evtrace_now();
+
+    USDT1(examlib, timer_entry, slot->index);
+    slot->callback(slot->arg);
+    USDT1(examlib, timer_return, slot->index);
+    evtrace_add(EVT_TIMER_EXPIRY, slot->index, 0, t0, 0);
+}
+
 /* Timer initialization */
 void init_timer(void (*callback)(union sigval arg), 
                 struct sigevent *se, 
@@ -260,10 +358,21 @@ void init_timer(void (*callback)(union sigval arg),
                 int seconds)
 {
 
+    struct timer_slot *slot = NULL;
+
+    /* Trace the expiries through the trampoline while slots are left */
+    if (timer_count < MAX_TIMERS) {
+        slot = &timer_slots[timer_count];
+        slot->callback          = callback;
+        slot->arg.sival_ptr     = timerid;
+        slot->index             = timer_count++;
+        evtrace_add(EVT_TIMER_INIT, slot->index, seconds * 1000000 + nanoseconds / 1000, 0, 0);
+    }
+
     /* Setup signal handling and callback for timer 1 */
     se->sigev_notify             = SIGEV_THREAD;
-    se->sigev_value.sival_ptr    = timerid;
-    se->sigev_notify_function    = callback;
+    se->sigev_value.sival_ptr    = slot ? (void *) slot : (void *) timerid;
+    se->sigev_notify_function    = slot ? timer_trampoline : callback;
     se->sigev_notify_attributes  = NULL;
     
     /* Create the timer and check for any errosr */
@@ -288,6 +397,35 @@ void start_timer(struct itimerspec *ts, time_t *timerid)
     }
 }
 
+/* Event type and value of a sysfs gpio operation */
+static void trace_gpio(uint8_t function, uint32_t gpio, int32_t value, uint64_t t0, int failed)
+{
+    static const uint16_t type[] = {
+        [GPIO_SYSFS_EXPORT]        = EVT_GPIO_EXPORT,
+        [GPIO_SYSFS_UNEXPORT]      = EVT_GPIO_UNEXPORT,
+        [GPIO_SYSFS_SET_DIRECTION] = EVT_GPIO_SET_DIRECTION,
+        [GPIO_SYSFS_GET_VALUE]     = EVT_GPIO_GET_VALUE,
+        [GPIO_SYSFS_SET_VALUE]     = EVT_GPIO_SET_VALUE,
+    };
+
+    if (function < sizeof(type) / sizeof(type[0]) && type[function] != 0) {
+        evtrace_add(type[function], gpio, value, t0, failed);
+    }
+}
+
+static int32_t trace_value(uint8_t function, uint32_t gpio, const char *val)
+{
+    switch (function) {
+    case GPIO_SYSFS_GET_VALUE:
+    case GPIO_SYSFS_SET_VALUE:
+        return val[0] - '0';
+    case GPIO_SYSFS_SET_DIRECTION:
+        return strcmp(val, IN) == 0 ? INPUT : OUTPUT;
+    default:
+        return gpio;
+    }
+}
+
 /* sysfs_gpio_handler - handle GPIO operations */
 int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
 {
@@ -297,6 +435,10 @@ int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
     int32_t  fd;
     uint32_t len;
     uint8_t  inval;
+    ssize_t  io = 0;
+    int32_t  value;
+    uint64_t t0 = evtrace_now();
+    uint64_t ns;
 
     /* Determine open flags based on function */
     switch (function) {
@@ -338,6 +480,10 @@ int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
     fd = open(path_str, oflags);
     if (fd  < 0) {
         perror(path_str);
+        ns = evtrace_now() - t0;
+        gpio_stats_add(function, gpio, ns, GPIO_STATS_ERR_OPEN);
+        USDT5(examlib, gpio_op, function, gpio, -1, ns, GPIO_STATS_ERR_OPEN);
+        trace_gpio(function, gpio, -1, t0, 1);
         return fd;
     }
 
@@ -349,38 +495,48 @@ int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
 #ifdef DEBUG
         printf("exp/unexp:%s\n", strBuf);
 #endif
-        write(fd, strBuf, len);
+        io = write(fd, strBuf, len);
         break;
 
     case GPIO_SYSFS_SET_DIRECTION:
 #ifdef DEBUG
         printf("write dir:%s\n", val);
 #endif
-        write(fd, val, strlen(val)+1);
+        io = write(fd, val, strlen(val)+1);
         break;
 
     case GPIO_SYSFS_SET_VALUE:
 #ifdef DEBUG
         printf("write val:%s\n", val);
 #endif
-        write(fd, val, strlen(val)+1);
+        io = write(fd, val, strlen(val)+1);
         break;
 
     case GPIO_SYSFS_GET_DIRECTION:
         break;
 
     case GPIO_SYSFS_GET_VALUE:
-        read(fd, &inval, 1);
+        if ((io = read(fd, &inval, 1)) == 1) {
+            *val = inval;
+        }
 #ifdef DEBUG
         printf("read val:%c\n", inval);
 #endif
-        *val = inval;
         break;
 
     default:
         printf("function not defined\n");
     }
     close(fd);
+    ns    = evtrace_now() - t0;
+    value = io < 0 ? -1 : trace_value(function, gpio, val);
+    gpio_stats_add(function, gpio, ns, io < 0 ? GPIO_STATS_ERR_IO : GPIO_STATS_OK);
+    USDT5(examlib, gpio_op, function, gpio, value, ns, io < 0 ? GPIO_STATS_ERR_IO : GPIO_STATS_OK);
+    trace_gpio(function, gpio, value, t0, io < 0);
+    if (io < 0) {
+        perror(path_str);
+        return -1;
+    }
     return 0;
 }
 
@@ -399,57 +555,105 @@ void init_gpio(void)
     }
 }
 
-float read_adc_value(void) 
+int32_t read_adc_raw(void)
 {
 	int charRead;
+    uint64_t t0 = evtrace_now();
     int32_t adc_fd = open(AIN4_DEV, O_RDONLY);
     char adc_buffer[BUFFER_SIZE];
+    int32_t raw;
 
     if(adc_fd  < 0){
       perror("Dev not readable");
+      USDT3(examlib, adc_sample, AIN_CHANNEL, -1, t0);
+      evtrace_add(EVT_ADC_SAMPLE, AIN_CHANNEL, -1, t0, 1);
       return adc_fd;
     }
 
-    charRead = read(adc_fd, adc_buffer, sizeof(adc_buffer));
+    charRead = read(adc_fd, adc_buffer, sizeof(adc_buffer) - 1);
     close(adc_fd);
-    
+
 	if (charRead != -1){
       adc_buffer[charRead] = '\0';
-      float aValue = (float)atoi(adc_buffer);
-      aValue = (V_REF * aValue) / ((1<<12)-1);
-
-      return aValue;
+      raw = atoi(adc_buffer);
+      USDT3(examlib, adc_sample, AIN_CHANNEL, raw, t0);
+      evtrace_add(EVT_ADC_SAMPLE, AIN_CHANNEL, raw, t0, 0);
+      return raw;
     }
 
+    USDT3(examlib, adc_sample, AIN_CHANNEL, -1, t0);
+    evtrace_add(EVT_ADC_SAMPLE, AIN_CHANNEL, -1, t0, 1);
     return -1;
 }
 
-/* Handle sigint via ctrl c*/
-void signal_ctrlc_handler(int signum)
+float read_adc_value(void) 
 {
-	int i;
-    printf("\nExit via Ctrl-C\n\n"); 	// Inform user
+    int32_t raw = read_adc_raw();
 
-    /* Unexport all selected gpios */
-    for (i=0; i<MAX_GPIO; i++) {
-        sysfs_gpio_handler(GPIO_SYSFS_UNEXPORT, gpio_led[i], NULL);
-        sysfs_gpio_handler(GPIO_SYSFS_UNEXPORT, gpio_btn[i], NULL);
+    if (raw < 0) {
+      return raw;
     }
+    return (V_REF * raw) / ((1<<12)-1);
+}
 
-    exit(signum);						// Terminate
+/* Feed the adaptive sampler and re-arm on a new rate, serialized against overlapping timer threads */
+uint32_t adc_rate_update(int32_t raw, bool *changed)
+{
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    struct itimerspec ts;
+    uint32_t period;
+
+    pthread_mutex_lock(&lock);
+    period = adc_rate.period_us;
+    *changed = (adc_sampler_update(&adc_rate, raw) != period);
+    period = adc_rate.period_us;
+    if (*changed) {
+        ts.it_value.tv_sec  = period / ONE_SECOND;
+        ts.it_value.tv_nsec = (period % ONE_SECOND) * 1000;
+        ts.it_interval      = ts.it_value;
+        start_timer(&ts, &timerid_adc);
+    }
+    pthread_mutex_unlock(&lock);
+    return period;
+}
+
+/* Report the sample budget saved by the adaptive adc rate */
+void report_adc_rate(void)
+{
+    printf("ADC samples taken: %llu, at fixed fast rate: %llu, saved: %llu\n",
+           (unsigned long long) adc_rate.samples,
+           (unsigned long long) adc_sampler_budget(&adc_rate),
+           (unsigned long long) adc_sampler_saved(&adc_rate));
+}
+
+/* Write the flight recorder to EVTRACE_FILE */
+void dump_trace(void)
+{
+    int n = evtrace_dump(EVTRACE_FILE);
+
+    if (n < 0) {
+        perror(EVTRACE_FILE);
+    } else {
+        fprintf(stderr, "evtrace: %d events written to %s\n", n, EVTRACE_FILE);
+    }
 }
 
-/* Handle sigint via term*/
-void signal_terminate_handler(int signum)
+/* Exit on SIGINT or SIGTERM, called from main after sigwait() */
+void exit_cleanup(int signum)
 {
 	int i;
-    printf("\nExit via Ctrl-C\n\n"); 	// Inform user
+
+    alog_stop();						// Write the pending log records
+    printf("\nExit via %s\n\n", signum == SIGINT ? "Ctrl-C" : "SIGTERM"); 	// Inform user
+    report_adc_rate();
+    alog_report(stdout);
 
     /* Unexport all selected gpios */
     for (i=0; i<MAX_GPIO; i++) {
         sysfs_gpio_handler(GPIO_SYSFS_UNEXPORT, gpio_led[i], NULL);
         sysfs_gpio_handler(GPIO_SYSFS_UNEXPORT, gpio_btn[i], NULL);
     }
+    dump_trace();
 
     exit(signum);						// Terminate
 }
@@ -458,35 +662,56 @@ void signal_terminate_handler(int signum)
 int main(int argc, char *argv[])
 {    
 	sigset_t 	set;
+	int		sig = 0;
 
-	/* SIGTERM handling */
-    signal(SIGINT, signal_ctrlc_handler); 				// register signal handler
-    signal(SIGTERM, signal_terminate_handler);			// Register SIGTERM signal handler
+	/* SIGINT, SIGTERM, SIGUSR1 and SIGUSR2 are blocked in all threads and taken by sigwait */
     sigemptyset(&set);									// Initializes the signalmask to empty
-    sigaddset(&set, SIGALRM );							// Set the signal mask for the signal handler
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGUSR1);							// Print the GPIO statistics
+    sigaddset(&set, SIGUSR2);							// Dump the event trace
+    pthread_sigmask(SIG_BLOCK, &set, NULL);				// Inherited by the timer threads
+
+	/* Start the logger before the first timer fires */
+    fmt_adc = alog_register("AIN4: %fV\n");
+    if (fmt_adc < 0 || alog_start(stdout) < 0) {
+        fprintf(stderr, "alog setup failed\n");
+        return -1;
+    }
 
-	/* Init timers */
-    init_timer(callback_adc, &se_timer_adc, &ts_adc, &timerid_adc, 0, 1);			// adc polling timer
+	/* Init timers, the adc timer starts at the fast rate */
+    adc_sampler_init(&adc_rate, ADC_SAMPLER_FAST_US, ADC_SAMPLER_SLOW_US, ADC_SAMPLER_THRESHOLD, ADC_SAMPLER_HOLD);
+    init_timer(callback_adc, &se_timer_adc, &ts_adc, &timerid_adc, ADC_SAMPLER_FAST_US * 1000, 0);	// adc polling timer
     init_timer(callback_btn, &se_timer_btn, &ts_btn, &timerid_btn, 500000000, 0);	// button polling timer
     init_timer(callback_1, &se_timer1, &ts_1, &timerid_1, 0, 1);		
     init_timer(callback_2, &se_timer2, &ts_2, &timerid_2, 500000000, 0);
     init_timer(callback_3, &se_timer3, &ts_3, &timerid_3, 250000000, 0);
     init_timer(callback_4, &se_timer4, &ts_4, &timerid_4, 125000000, 0);
     
-    /* Start Timers */
+    /* Start Timers, with -b the buttons drive the LEDs instead of the blink timers */
     start_timer(&ts_adc, &timerid_adc);
-    //start_timer(&ts_btn, &timerid_btn);
-    start_timer(&ts_1, &timerid_1);
-    start_timer(&ts_2, &timerid_2);
-    start_timer(&ts_3, &timerid_3);
-    start_timer(&ts_4, &timerid_4);
+    if (argc > 1 && strcmp(argv[1], "-b") == 0) {
+        start_timer(&ts_btn, &timerid_btn);
+    } else {
+        start_timer(&ts_1, &timerid_1);
+        start_timer(&ts_2, &timerid_2);
+        start_timer(&ts_3, &timerid_3);
+        start_timer(&ts_4, &timerid_4);
+    }
 
 	init_gpio(); // init buttons and leds
 
 
-    while (1) {
-		;
+    /* Statistics on SIGUSR1, trace dump on SIGUSR2, exit on SIGINT or SIGTERM */
+    while (sigwait(&set, &sig) != 0 || sig == SIGUSR1 || sig == SIGUSR2) {
+		if (sig == SIGUSR1) {
+			gpio_stats_print(stdout, gpio_action_name);
+		} else if (sig == SIGUSR2) {
+			dump_trace();
+		}
+		sig = 0;
     }
+    exit_cleanup(sig);
 
     return 0;
 }
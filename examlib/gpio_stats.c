@@ -0,0 +1,227 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux gpio_stats
+ *
+ *          Lock-free per-action, per-line GPIO statistics. See gpio_stats.h
+ *          for an overview.
+ *
+ * \file    gpio_stats.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "gpio_stats.h"
+
+/* Line slot, gpio is GPIO_STATS_FREE until claimed */
+#define GPIO_STATS_FREE		-1
+
+struct gpio_stats_line {
+    int32_t gpio;
+    struct gpio_stats_op op[GPIO_STATS_ACTIONS];
+};
+
+static struct gpio_stats_line gpio_stats_lines[GPIO_STATS_LINES] = {
+    [0 ... GPIO_STATS_LINES - 1] = { .gpio = GPIO_STATS_FREE }
+};
+
+/* Calls on lines that found no free slot */
+static uint64_t gpio_stats_overflow;
+
+/*
+ ***************************************************************************
+ * Slot of a line, claimed on first use. NULL if all slots are taken.
+ ***************************************************************************
+ */
+static struct gpio_stats_line *gpio_stats_line(uint32_t gpio)
+{
+    struct gpio_stats_line *l;
+    int32_t cur;
+    int i;
+
+    for (i = 0; i < GPIO_STATS_LINES; i++) {
+        l = &gpio_stats_lines[i];
+        cur = __atomic_load_n(&l->gpio, __ATOMIC_ACQUIRE);
+        if (cur == GPIO_STATS_FREE) {
+            if (__atomic_compare_exchange_n(&l->gpio, &cur, (int32_t) gpio, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return l;
+            }
+        }
+        if (cur == (int32_t) gpio) {
+            return l;
+        }
+    }
+    return NULL;
+}
+
+/*
+ ***************************************************************************
+ * Account one operation that took ns
+ ***************************************************************************
+ */
+void gpio_stats_add(unsigned action, uint32_t gpio, uint64_t ns, enum gpio_stats_err err)
+{
+    struct gpio_stats_line *l;
+    struct gpio_stats_op *op;
+    uint64_t max;
+    int k;
+
+    if (action >= GPIO_STATS_ACTIONS || (l = gpio_stats_line(gpio)) == NULL) {
+        __atomic_fetch_add(&gpio_stats_overflow, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    op = &l->op[action];
+
+    __atomic_fetch_add(&op->calls, 1, __ATOMIC_RELAXED);
+    if (err == GPIO_STATS_ERR_OPEN) {
+        __atomic_fetch_add(&op->open_errors, 1, __ATOMIC_RELAXED);
+    } else if (err == GPIO_STATS_ERR_IO) {
+        __atomic_fetch_add(&op->io_errors, 1, __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&op->sum_ns, ns, __ATOMIC_RELAXED);
+
+    max = __atomic_load_n(&op->max_ns, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&op->max_ns, &max, ns, 1,
+                                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        ;
+    }
+
+    k = ns ? 63 - __builtin_clzll(ns) : 0;
+    __atomic_fetch_add(&op->hist[k < GPIO_STATS_HIST ? k : GPIO_STATS_HIST - 1], 1, __ATOMIC_RELAXED);
+}
+
+/*
+ ***************************************************************************
+ * Copy the counters of one slot, each counter is read atomically
+ ***************************************************************************
+ */
+static void gpio_stats_copy(struct gpio_stats_op *dst, struct gpio_stats_op *src)
+{
+    int k;
+
+    dst->calls       = __atomic_load_n(&src->calls, __ATOMIC_RELAXED);
+    dst->open_errors = __atomic_load_n(&src->open_errors, __ATOMIC_RELAXED);
+    dst->io_errors   = __atomic_load_n(&src->io_errors, __ATOMIC_RELAXED);
+    dst->sum_ns      = __atomic_load_n(&src->sum_ns, __ATOMIC_RELAXED);
+    dst->max_ns      = __atomic_load_n(&src->max_ns, __ATOMIC_RELAXED);
+    for (k = 0; k < GPIO_STATS_HIST; k++) {
+        dst->hist[k] = __atomic_load_n(&src->hist[k], __ATOMIC_RELAXED);
+    }
+}
+
+static void gpio_stats_merge(struct gpio_stats_op *dst, const struct gpio_stats_op *src)
+{
+    int k;
+
+    dst->calls       += src->calls;
+    dst->open_errors += src->open_errors;
+    dst->io_errors   += src->io_errors;
+    dst->sum_ns      += src->sum_ns;
+    if (src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+    for (k = 0; k < GPIO_STATS_HIST; k++) {
+        dst->hist[k] += src->hist[k];
+    }
+}
+
+/*
+ ***************************************************************************
+ * Upper bound of the histogram bucket holding the percentile, at most max
+ ***************************************************************************
+ */
+static uint64_t gpio_stats_pct(const struct gpio_stats_op *op, unsigned pct)
+{
+    uint64_t total = 0, want, seen = 0;
+    int k;
+
+    for (k = 0; k < GPIO_STATS_HIST; k++) {
+        total += op->hist[k];
+    }
+    want = total * pct / 100;
+    for (k = 0; k < GPIO_STATS_HIST; k++) {
+        seen += op->hist[k];
+        if (seen > want) {
+            return (2ULL << k) < op->max_ns ? (2ULL << k) : op->max_ns;
+        }
+    }
+    return op->max_ns;
+}
+
+static void gpio_stats_row(FILE *out, const char *action, const char *line, const struct gpio_stats_op *op)
+{
+    fprintf(out, "%-14s %-5s %9llu %7llu %7llu %9llu %9llu %9llu %9llu\n",
+            action, line, (unsigned long long) op->calls,
+            (unsigned long long) op->open_errors, (unsigned long long) op->io_errors,
+            (unsigned long long) (op->calls ? op->sum_ns / op->calls : 0),
+            (unsigned long long) gpio_stats_pct(op, 50),
+            (unsigned long long) gpio_stats_pct(op, 99),
+            (unsigned long long) op->max_ns);
+}
+
+/*
+ ***************************************************************************
+ * Print a snapshot: per action over all lines, then per line
+ ***************************************************************************
+ */
+void gpio_stats_print(FILE *out, const char *const action_name[GPIO_STATS_ACTIONS])
+{
+    static struct gpio_stats_op snap[GPIO_STATS_LINES][GPIO_STATS_ACTIONS];
+    struct gpio_stats_op total;
+    int32_t gpio[GPIO_STATS_LINES];
+    char name[16];
+    int a, i;
+
+    for (i = 0; i < GPIO_STATS_LINES; i++) {
+        gpio[i] = __atomic_load_n(&gpio_stats_lines[i].gpio, __ATOMIC_ACQUIRE);
+        for (a = 0; a < GPIO_STATS_ACTIONS; a++) {
+            gpio_stats_copy(&snap[i][a], &gpio_stats_lines[i].op[a]);
+        }
+    }
+
+    fprintf(out, "%-14s %-5s %9s %7s %7s %9s %9s %9s %9s\n", "action", "gpio",
+            "calls", "open_e", "io_e", "mean_ns", "p50<=ns", "p99<=ns", "max_ns");
+    for (a = 0; a < GPIO_STATS_ACTIONS; a++) {
+        memset(&total, 0, sizeof(total));
+        for (i = 0; i < GPIO_STATS_LINES; i++) {
+            gpio_stats_merge(&total, &snap[i][a]);
+        }
+        if (total.calls) {
+            gpio_stats_row(out, action_name[a], "all", &total);
+        }
+    }
+    for (i = 0; i < GPIO_STATS_LINES; i++) {
+        if (gpio[i] == GPIO_STATS_FREE) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "%d", gpio[i]);
+        for (a = 0; a < GPIO_STATS_ACTIONS; a++) {
+            if (snap[i][a].calls) {
+                gpio_stats_row(out, action_name[a], name, &snap[i][a]);
+            }
+        }
+    }
+    if (__atomic_load_n(&gpio_stats_overflow, __ATOMIC_RELAXED)) {
+        fprintf(out, "%llu calls not counted, more than %d lines\n",
+                (unsigned long long) __atomic_load_n(&gpio_stats_overflow, __ATOMIC_RELAXED),
+                GPIO_STATS_LINES);
+    }
+    fflush(out);
+}
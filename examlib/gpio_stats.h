@@ -0,0 +1,64 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded Linux gpio_stats
+ *
+ *          Call counters and latency histograms of the sysfs GPIO
+ *          operations, kept per action (EXPORT, SET_DIRECTION, ...) and
+ *          per GPIO line. Recording is lock-free: a line takes a slot with
+ *          compare-and-swap the first time it is seen, the counters are
+ *          relaxed atomic adds. A snapshot may therefore be printed at any
+ *          time from another thread without stopping the callers.
+ *
+ *          hist[k] counts operations taking [2^k, 2^(k+1)) ns.
+ *
+ * \file    gpio_stats.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Schmocker Aaron
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2016 Aaron Schmocker, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef GPIO_STATS_H
+#define GPIO_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Configuration */
+#define GPIO_STATS_ACTIONS	6	/* Actions of sysfs_gpio_handler */
+#define GPIO_STATS_LINES	16	/* GPIO lines tracked */
+#define GPIO_STATS_HIST		28	/* Up to 2^28 ns = 268 ms */
+
+/* Error kinds */
+enum gpio_stats_err {
+    GPIO_STATS_OK = 0,
+    GPIO_STATS_ERR_OPEN,	/* open() of the sysfs file failed */
+    GPIO_STATS_ERR_IO,		/* read() or write() failed */
+};
+
+/* Counters of one action on one line */
+struct gpio_stats_op {
+    uint64_t calls;
+    uint64_t open_errors;
+    uint64_t io_errors;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t hist[GPIO_STATS_HIST];
+};
+
+/* Prototypes */
+void gpio_stats_add(unsigned action, uint32_t gpio, uint64_t ns, enum gpio_stats_err err);
+void gpio_stats_print(FILE *out, const char *const action_name[GPIO_STATS_ACTIONS]);
+
+#endif /* GPIO_STATS_H */
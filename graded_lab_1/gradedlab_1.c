@@ -12,6 +12,12 @@
  * \remark  V1.0, AOM1, 25.10.2013   Initial release
  * \remark  V1.1, AOM1, 20.11.2015   Added POSIX Timer Handling
  * \remark  V1.2, SCHMA5, 30.11.2015 Implemented moving light
+ * \remark  V1.3, SCHMA5, 18.10.2026 USDT probes, see below
+ *
+ *          USDT probes (usdt.h, provider gradedlab):
+ *          gpio_entry(function, gpio), gpio_return(function, gpio, value,
+ *          ret), buttons(pressed_mask, edge_mask, state, dir) and
+ *          moving_light(led, ms, dir) on every step of the light.
  ***************************************************************************
  *
  * Copyright (C) 2015 Aaron Schmocker, Bern University of Applied Scinces
@@ -47,10 +53,17 @@
 #include <sys/stat.h>
 #include <sys/ioctl.h>
 
+#include "usdt.h"
+
 #undef DEBUG
 
+/* Where sysfs is mounted */
+#ifndef SYSFS_ROOT
+#define SYSFS_ROOT		"/sys"
+#endif
+
 /* Define some useful constants */
-#define SYSFS_PATH		"/sys/class/gpio/"
+#define SYSFS_PATH		SYSFS_ROOT "/class/gpio/"
 #define MAX_STR_BUF		512
 #define MAX_PATH_STR	512
 #define LOW		    	0
@@ -120,6 +133,8 @@ int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
     uint32_t len;
     uint8_t  inval;
 
+    USDT2(gradedlab, gpio_entry, function, gpio);
+
     /* Determine open flags based on function */
     switch (function) {
     case GPIO_SYSFS_EXPORT:
@@ -160,6 +175,7 @@ int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
     fd = open(path_str, oflags);
     if (fd  < 0) {
         perror(path_str);
+        USDT4(gradedlab, gpio_return, function, gpio, -1, fd);
         return fd;
     }
 
@@ -203,6 +219,8 @@ int sysfs_gpio_handler(uint8_t function, uint32_t gpio, char *val)
         printf("function not defined\n");
     }
     close(fd);
+    USDT4(gradedlab, gpio_return, function, gpio,
+          (function == GPIO_SYSFS_GET_VALUE || function == GPIO_SYSFS_SET_VALUE) ? val[0] - '0' : -1, 0);
     return 0;
 }
 
@@ -274,6 +292,7 @@ void update_buttons()
     int i = 0;
     char new_button[4]  = {0,0,0,0};
     char edge_button[4] = {0,0,0,0};
+    uint8_t pressed = 0, edges = 0;
 
     // Read button values
     for(i = 0; i < 4; i++) {
@@ -284,6 +303,8 @@ void update_buttons()
     for(i = 0; i < 4; i++) {
         edge_button[i] = ((new_button[i] == PRESSED) && (button[i] != PRESSED));
         button[i] = new_button[i];
+        pressed |= (new_button[i] == PRESSED) << i;
+        edges   |= edge_button[i] << i;
     }
 
     // Button T1: End Programm
@@ -318,6 +339,8 @@ void update_buttons()
     if(edge_button[T4]) {
         dir = !dir;
     }
+
+    USDT4(gradedlab, buttons, pressed, edges, state, dir);
 }
 
 /*
@@ -370,6 +393,7 @@ void moving_light(long miliseconds, bool direction)
             advanced_sleep(1, miliseconds);
             kill_all_leds();
             sysfs_gpio_handler(GPIO_SYSFS_SET_VALUE, gpio_led[i], ON);
+            USDT3(gradedlab, moving_light, i, miliseconds, direction);
         }
     } else {
         // Moving up
@@ -377,6 +401,7 @@ void moving_light(long miliseconds, bool direction)
             advanced_sleep(1, miliseconds);
             kill_all_leds();
             sysfs_gpio_handler(GPIO_SYSFS_SET_VALUE, gpio_led[i], ON);
+            USDT3(gradedlab, moving_light, i, miliseconds, direction);
         }
     }
 }
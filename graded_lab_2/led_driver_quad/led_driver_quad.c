@@ -13,21 +13,101 @@
  *   echo "off" > /dev/led0..3  to set LED1 off
  *   cat /dev/led0..3              to get the status of LED1
  *
+ *   The aggregate node /dev/leds gets or sets all LEDs in one syscall,
+ *   either with a binary __u64 read/write or with the LED_IOC_* ioctls
+ *   declared in led_driver_quad.h. Multi-LED updates use the gpio array
+ *   API, so lines on the same bank change with one register write.
+ *   A binary batch (struct led_batch_hdr plus entries) written to
+ *   /dev/leds carries many commands and is applied as one update.
+ *
+ *   Uploaded patterns are played by an hrtimer with absolute deadlines,
+ *   LED_IOC_PATTERN_STATUS reports the progress and the timer lateness.
+ *   Writes from userspace during a pattern are overwritten by its next
+ *   frame.
+ *
+ *   Each node has a command queue sorted by deadline. The queue timer is
+ *   always programmed to the earliest deadline, the results (lateness per
+ *   command) are fetched one by one with LED_IOC_QUEUE_RESULT.
+ *
+ *   Every open file remembers the change count of its node it has seen.
+ *   poll() compares it with the current count, led_wait is woken on each
+ *   change. In event mode read() blocks for the next change.
+ *
+ *   Software PWM: one hrtimer serves all dimmed LEDs. At the start of a
+ *   period all of them go on with one update, then the timer visits the
+ *   off edges sorted by time, LEDs with the same duty share an edge. Duty
+ *   and frequency changes take effect at the next period.
+ *
+ *   No printk on the file operations: they hit tracepoints (see
+ *   led_driver_quad_trace.h) and per-CPU counters per minor. The sums
+ *   and the latency histograms are in /sys/kernel/debug/led_driver_quad/
+ *   stats, timing the calls is enabled with latency_enable.
+ *
+ *   Each open file keeps its minor in struct led_file. The LED state is
+ *   a bitmap changed with atomic bitops. A write to one LED takes no lock:
+ *   it flips the bit, sets the gpio and bumps the change count of the
+ *   node. Only updates of several LEDs at once (one array call) take
+ *   led_lock, and the status page is published by whoever holds it, for
+ *   all changes so far. Reads are served from the bitmap without a lock.
+ *
+ *   Every node can be mapped read-only (one page). The page holds the
+ *   LED mask, a sequence count and the time of the last change, see
+ *   struct led_status_page.
+ *
+ *   The buttons T1..4 are read through /dev/btn0..3. Both edges raise an
+ *   interrupt. The first edge is reported at once and starts a lockout
+ *   of debounce_ms (module parameter), after which the line is sampled
+ *   again to catch a change that happened during the lockout. The events
+ *   wait in a kfifo per button for read() and poll(). If a button gpio or
+ *   interrupt is taken (e.g. exported through sysfs by examlib) the driver
+ *   loads without /dev/btnN, buttons=0 leaves them out on purpose.
+ *
+ *   A button can also drive LEDs by itself (direct, inverted or toggle on
+ *   press, BTN_IOC_SET_REFLEX). The mapping is applied in the interrupt
+ *   together with the event, the latency from the interrupt to the LED
+ *   write is kept as a log2 histogram.
+ *
  *   This driver allows you to flash LED1..4 on the BBB-BFH-Cape
  *
  *   General purpose I/O (GPIO) is used to drive the LED.
- *   Current GPIO assignments for the LED:
+ *   Default GPIO assignments for the LED:
  *	 LED1	GPIO# is 61;  Pin P8-26, GPIO1_29
  *   LED2   GPIO# is 44;
  *   LED3   GPIO# is 68;
  *   LED4   GPIO# is 67;
  *
+ *   The LED gpios are a module parameter, one node /dev/ledN per entry
+ *   and up to 64 LEDs (the width of the masks):
+ *   modprobe led_driver_quad gpios=61,44,68,67,26,46
+ *   All per LED state is allocated for that count at load time.
+ *
+ *   Current GPIO assignments for the buttons (active low):
+ *   T1     GPIO# is 49;
+ *   T2     GPIO# is 112;
+ *   T3     GPIO# is 51;
+ *   T4     GPIO# is 7;
+ *
  *
  *   Insert the driver with: modprobe led_driver_quad
  *   Remove the driver with: modprobe -r led_driver_quad
  *
  * \remark  Last Modifications:
  * \remark  V1.0, SCHMA5, 08.01.2016   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Aggregate /dev/leds node, bitmask ioctl
+ * \remark  V1.2, SCHMA5, 18.10.2026   mmap-able LED status page
+ * \remark  V1.3, SCHMA5, 18.10.2026   Batch write protocol, no printk per command
+ * \remark  V1.4, SCHMA5, 18.10.2026   hrtimer pattern engine
+ * \remark  V1.5, SCHMA5, 18.10.2026   Deadline-stamped command queue
+ * \remark  V1.6, SCHMA5, 18.10.2026   poll() and change events
+ * \remark  V1.7, SCHMA5, 18.10.2026   IRQ driven, debounced button nodes
+ * \remark  V1.8, SCHMA5, 18.10.2026   In-kernel button to LED reflex
+ * \remark  V1.9, SCHMA5, 18.10.2026   hrtimer software PWM
+ * \remark  V1.10, SCHMA5, 18.10.2026  Tracepoints, per-CPU statistics, debugfs
+ * \remark  V1.11, SCHMA5, 18.10.2026  LED gpios as module parameter, dynamic state
+ * \remark  V1.13, SCHMA5, 18.10.2026  Lock-free single-LED writes
+ * \remark  V1.14, SCHMA5, 18.10.2026  Change events carry the time of the node's change
+ * \remark  V1.15, SCHMA5, 18.10.2026  LEDs load without the buttons, buttons= parameter
+ * \remark  V1.12, SCHMA5, 18.10.2026  Per-open minor, lock-free reads and no-op writes
  ***************************************************************************
  *
  * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
@@ -63,6 +143,30 @@
 #include <linux/fs.h>		/* fs ops */
 #include <asm/uaccess.h>	/* copy_to_user, copy_from_usr, ... */
 #include <asm/gpio.h>
+#include <linux/gpio.h>
+#include <linux/gpio/consumer.h>	/* gpio descriptors, array API */
+#include <linux/spinlock.h>
+#include <linux/bitops.h>
+#include <linux/mm.h>		/* mmap of the status page */
+#include <linux/ktime.h>
+#include <linux/hrtimer.h>	/* Pattern engine, queues, PWM */
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/wait.h>		/* Change notification */
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/interrupt.h>	/* Button interrupts */
+#include <linux/kfifo.h>
+#include <linux/moduleparam.h>
+#include <linux/percpu.h>	/* Statistics */
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+
+#include "led_driver_quad.h"
+
+#define CREATE_TRACE_POINTS
+#include "led_driver_quad_trace.h"
 
 /*****************************************************************************/
 /* Macros and Constants							                             */
@@ -78,7 +182,12 @@
 #define LED_DRIVER_VER		"1.0"
 
 #define FIRTS_MINOR_NR		0
-#define HOW_MANY_MINORS		4
+#define DEF_LEDS		4
+#define LED_MAX			64	/* LED masks are __u64 */
+
+/* The aggregate node /dev/leds follows the LED minors */
+#define LED_AGGR_MINOR		num_leds
+#define NUM_MINORS		(num_leds + 1)
 
 #define MAX_MSG_SIZE		32
 
@@ -90,223 +199,1795 @@
 #define ON			        0
 #define OFF			        1
 
+#define BTN_MODULE_NAME		"led_driver_quad_btn"
+#define HOW_MANY_BUTTONS	4
+
+#define BTN_1			    49
+#define BTN_2			    112
+#define BTN_3			    51
+#define BTN_4			    7
+
+#define BTN_PRESSED		    0
+#define BTN_FIFO_SIZE		64	/* Events per button, power of 2 */
+#define BTN_DEBOUNCE_MS		20
+
 /*****************************************************************************/
 /* Variables etc. 							                                 */
 /*****************************************************************************/
 
-uint16_t leds[HOW_MANY_MINORS]  = { LED_1, LED_2, LED_3, LED_4 };
+/* LED gpios, replaced by the gpios= module parameter */
+static int          leds[LED_MAX] = { LED_1, LED_2, LED_3, LED_4 };
+static unsigned int num_leds      = DEF_LEDS;
+module_param_array_named(gpios, leds, int, &num_leds, 0444);
+MODULE_PARM_DESC(gpios, "LED gpio numbers, one node /dev/ledN per entry (max 64)");
 
 static dev_t         first_dev;	  	/* First device number	*/
 static struct cdev   char_dev; 	  	/* The character device	*/
 static struct class *dev_class;   	/* The device class	*/
 
+/* Per LED and per node state, allocated for num_leds at load time */
+static struct gpio_desc **led_desc;	/* Descriptors for the array API */
+static char             (*led_label)[16];	/* gpio labels "ledN" */
+static u64               led_all_mask;	/* Bits of all LEDs */
+static DEFINE_SPINLOCK(led_lock);	/* Multi-LED updates, status page */
+
+/* LED state, bit set = on. Changed and read with atomic bitops, a single
+ * LED needs no lock */
+static unsigned long     led_bits[BITS_TO_LONGS(LED_MAX)];
+
+static struct led_status_page *led_status;	/* Page shared with userspace */
+static atomic_t          led_unpublished;	/* Changes not on the page yet */
+
+/* Change counts and the time of the last change per node, the time is
+ * stored before the count is bumped. The wait queue is woken on every
+ * change. */
+static atomic_t *led_seq;
+static u64      *led_changed_ns;
+static DECLARE_WAIT_QUEUE_HEAD(led_wait);
+
+/* Per open file state */
+struct led_file {
+    int minor;
+    u32 seen;			/* Change count of the node last reported */
+    int events;			/* read() returns struct led_event */
+};
+
+/* Pattern engine. pattern_mutex serializes start and stop, pattern_lock
+ * protects the progress that the timer updates. */
+static struct hrtimer     pattern_timer;
+static struct led_frame  *pattern_frames;
+static u32                pattern_count;
+static u32                pattern_loops;
+static struct led_pattern_status pattern_stat;
+static DEFINE_MUTEX(pattern_mutex);
+static DEFINE_SPINLOCK(pattern_lock);
+
+/* Deadline-stamped command queue of one node. cmd[] is sorted by
+ * deadline, the results form a ring. All protected by lock. */
+struct led_queue {
+    struct hrtimer          timer;
+    spinlock_t              lock;
+    u64                     allowed;	/* LEDs the node may change */
+    struct led_timed_cmd    cmd[LED_QUEUE_DEPTH];
+    u32                     count;
+    struct led_queue_result result[LED_QUEUE_RESULTS];
+    u32                     res_head;
+    u32                     res_count;
+    struct led_queue_stats  stats;
+};
+
+static struct led_queue *led_queues;
+
+/* Software PWM, all protected by pwm_lock. pwm_edge[] holds the off edges
+ * of the current period sorted by offset, pwm_next the one due next
+ * (0 = start of the period). */
+struct led_pwm_edge {
+    u64 offset_ns;
+    u64 off_mask;
+};
+
+static struct hrtimer      pwm_timer;
+static DEFINE_SPINLOCK(pwm_lock);
+static u32                *pwm_duty;
+static u32                 pwm_freq = LED_PWM_FREQ_DEF;
+static bool                pwm_dirty;	/* Rebuild the edges at the next period */
+static bool                pwm_running;
+static u64                 pwm_on_mask;	/* LEDs under PWM */
+static u64                 pwm_period_ns;
+static u64                 pwm_period_start;
+static struct led_pwm_edge *pwm_edge;
+static int                 pwm_edges;
+static int                 pwm_next;
+static u64                 pwm_start_ns;
+static struct led_pwm_stats pwm_stats;
+
+/* Statistics per minor, kept per CPU so the file operations never share
+ * a cache line. lat[op][k] counts calls taking [2^k, 2^(k+1)) ns. led_pcpu
+ * points to NUM_MINORS entries. */
+#define LED_LAT_HIST		24
+
+enum { LED_OP_READ, LED_OP_WRITE, LED_OPS };
+
+struct led_minor_stats {
+    u64 opens;
+    u64 closes;
+    u64 reads;
+    u64 writes;
+    u64 read_bytes;
+    u64 write_bytes;
+    u64 errors;
+    u32 lat[LED_OPS][LED_LAT_HIST];
+};
+
+static struct led_minor_stats __percpu *led_pcpu;
+static u32            led_lat_enable;	/* Time the calls, off by default */
+static struct dentry *led_debugfs;
+
+/* Buttons */
+uint16_t buttons[HOW_MANY_BUTTONS] = { BTN_1, BTN_2, BTN_3, BTN_4 };
+
+static bool btn_enable = true;
+module_param_named(buttons, btn_enable, bool, 0444);
+MODULE_PARM_DESC(buttons, "Create /dev/btn0..3, the LEDs work without them");
+static bool btn_active;		/* btn_init succeeded */
+
+static unsigned int debounce_ms = BTN_DEBOUNCE_MS;
+module_param(debounce_ms, uint, 0644);
+MODULE_PARM_DESC(debounce_ms, "Button debounce time in ms");
+
+/* State of one button. lock protects everything but the wait queue, it
+ * is taken by the interrupt handler and the debounce timer. */
+struct btn {
+    int               index;
+    int               irq;
+    spinlock_t        lock;
+    struct hrtimer    timer;	/* Ends the debounce lockout */
+    bool              lockout;
+    int               pressed;	/* Debounced state */
+    u32               lost;
+    struct btn_reflex reflex;	/* LEDs driven by the button */
+    struct btn_reflex_stats reflex_stats;
+    wait_queue_head_t wait;
+    DECLARE_KFIFO(fifo, struct btn_event, BTN_FIFO_SIZE);
+};
+
+static struct btn    btns[HOW_MANY_BUTTONS];
+static dev_t         btn_first_dev;	/* First button device number */
+static struct cdev   btn_char_dev;	/* The button character device */
+
 /****************************************************************************/
-/* File open								                                */
+/* Set the LED gpios selected by which to on_mask with one array call	    */
 /****************************************************************************/
 
-static int led_open(struct inode *inode, struct file *file_ptr)
+static void led_hw_set(u64 which, u64 on_mask)
 {
-    int major, minor;
+    struct gpio_desc *desc[LED_MAX];
+    int values[LED_MAX];
+    int i, n = 0;
 
-    major = imajor(inode);
-    minor = iminor(inode);
-    printk(KERN_INFO "Opening device node at major %d minor %d\n", major, minor);
-    return 0;
+    for (i=0; i<num_leds; i++) {
+        if (which & BIT_ULL(i)) {
+            desc[n]     = led_desc[i];
+            values[n++] = (on_mask & BIT_ULL(i)) ? ON : OFF;
+        }
+    }
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 20, 0)
+    {
+        DECLARE_BITMAP(bitmap, LED_MAX);
+
+        bitmap_zero(bitmap, LED_MAX);
+        for (i=0; i<n; i++) {
+            if (values[i]) {
+                __set_bit(i, bitmap);
+            }
+        }
+        gpiod_set_raw_array_value(n, desc, NULL, bitmap);
+    }
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION(4, 3, 0)
+    gpiod_set_raw_array_value(n, desc, values);
+#else
+    gpiod_set_raw_array(n, desc, values);
+#endif
 }
 
 /****************************************************************************/
-/* File close operations						                            */
+/* Bring the gpio of LED i in line with its bit. Writers racing on the same */
+/* LED may set the gpio in the other order than they changed the bit, so   */
+/* whoever set the gpio checks the bit again and repeats until they agree. */
 /****************************************************************************/
 
-static int led_close(struct inode *inode, struct file *file_ptr)
+static void led_hw_sync(int i, bool on)
 {
-    int major, minor;
+    bool set;
 
-    /* Get major and minor number */
-    major = imajor(inode);
-    minor = iminor(inode);
-    printk(KERN_INFO "Closing device node at major %d minor %d\n", major, minor);
-    return 0;
+    do {
+        set = on;
+        smp_mb();
+        on = test_bit(i, led_bits);
+        if (on != set) {
+            gpiod_set_raw_value(led_desc[i], on ? ON : OFF);
+        }
+    } while (on != set);
 }
 
 /****************************************************************************/
-/* File read operations							                            */
+/* State of all LEDs from the bitmap, without a lock. Each word is read     */
+/* atomically.								    */
 /****************************************************************************/
 
-static ssize_t led_read(struct file *file_ptr, char __user *user_buffer, size_t count, loff_t *f_pos)
+static u64 led_state_read(void)
 {
-    size_t len = count, status_length;
-    ssize_t retval = 0;
-    unsigned long ret = 0;
-    int major, minor;
-    char led_value;
-    char *onOff;
+    u64 state = READ_ONCE(led_bits[0]);
 
-    /* Get major and minor number */
-    major = MAJOR(file_ptr->f_path.dentry->d_inode->i_rdev);
-    minor = MINOR(file_ptr->f_path.dentry->d_inode->i_rdev);
+#if BITS_PER_LONG == 32
+    state |= (u64) READ_ONCE(led_bits[1]) << 32;
+#endif
+    return state;
+}
 
-    /* Get led status */
-    led_value = gpio_get_value(leds[minor]);
-    if (!led_value) {
-        onOff = "\non\n";
-    } else {
-        onOff = "\noff\n";
+/****************************************************************************/
+/* Publish the LED state on the status page. Who gets led_lock publishes    */
+/* the changes of all writers so far. A writer that finds the lock taken   */
+/* leaves its change to the holder, who looks again after unlocking, so    */
+/* single-LED writers never wait here.					    */
+/****************************************************************************/
+
+static void led_publish(void)
+{
+    unsigned long flags;
+    u64 now;
+    int n;
+
+    smp_mb__after_atomic();
+    while (atomic_read(&led_unpublished) && spin_trylock_irqsave(&led_lock, flags)) {
+        n = atomic_xchg(&led_unpublished, 0);
+        if (n) {
+            now = ktime_get_ns();
+            WRITE_ONCE(led_status->seq, led_status->seq + 1);
+            smp_wmb();
+            WRITE_ONCE(led_status->mask, led_state_read());
+            WRITE_ONCE(led_status->changed_ns, now);
+            WRITE_ONCE(led_status->changes, led_status->changes + n);
+            smp_wmb();
+            WRITE_ONCE(led_status->seq, led_status->seq + 1);
+            WRITE_ONCE(led_changed_ns[LED_AGGR_MINOR], now);
+            smp_mb__before_atomic();
+            atomic_add(n, &led_seq[LED_AGGR_MINOR]);
+        }
+        spin_unlock_irqrestore(&led_lock, flags);
+        smp_mb();
     }
-    status_length = strlen(onOff);
+    smp_mb();
+    if (waitqueue_active(&led_wait)) {
+        wake_up_interruptible(&led_wait);
+    }
+}
 
-    /* Check and adjust limits */
-    if (*f_pos >= status_length) {
-        return 0;
+/****************************************************************************/
+/* Change one LED without a lock, returns true if its state changed	    */
+/****************************************************************************/
+
+static bool led_change_one(int i, bool on, bool toggle)
+{
+    if (toggle) {
+        on = !test_and_change_bit(i, led_bits);
+    } else if (on ? test_and_set_bit(i, led_bits) : !test_and_clear_bit(i, led_bits)) {
+        return false;
     }
-    if (*f_pos + count > status_length) {
-        len = status_length - *f_pos;
+    gpiod_set_raw_value(led_desc[i], on ? ON : OFF);
+    led_hw_sync(i, on);
+    WRITE_ONCE(led_changed_ns[i], ktime_get_ns());
+    smp_mb__before_atomic();
+    atomic_inc(&led_seq[i]);
+    atomic_inc(&led_unpublished);
+    return true;
+}
+
+/****************************************************************************/
+/* Update the LEDs selected by mask to value, or toggle them, returns the   */
+/* new state. A single LED is changed with atomic bitops and no lock,	    */
+/* writers of different LEDs share nothing but the bitmap word. Several    */
+/* LEDs go through one array call under led_lock.			    */
+/****************************************************************************/
+
+static u64 led_change(u64 mask, u64 value, bool toggle)
+{
+    unsigned long flags;
+    u64 state, now, changed = 0;
+    int i;
+
+    mask &= led_all_mask;
+    if (mask == 0) {
+        return led_state_read();
     }
 
-    /* Copy message to user */
-    ret = copy_to_user(user_buffer, onOff, len);
-    *f_pos += len - ret;
-    retval = len - ret;
-    return retval;
+    if (hweight64(mask) == 1) {
+        i = __ffs64(mask);
+        if (led_change_one(i, value & mask, toggle)) {
+            changed = mask;
+        }
+    } else if (toggle || ((led_state_read() ^ value) & mask)) {
+        /* Updates that change nothing return before taking the lock */
+        spin_lock_irqsave(&led_lock, flags);
+        for (i=0; i<num_leds; i++) {
+            if (!(mask & BIT_ULL(i))) {
+                continue;
+            }
+            if (toggle) {
+                change_bit(i, led_bits);
+                changed |= BIT_ULL(i);
+            } else if ((value & BIT_ULL(i)) ? !test_and_set_bit(i, led_bits) :
+                                              test_and_clear_bit(i, led_bits)) {
+                changed |= BIT_ULL(i);
+            }
+        }
+        if (changed) {
+            state = led_state_read();
+            led_hw_set(changed, state);
+            now = ktime_get_ns();
+            for (i=0; i<num_leds; i++) {
+                if (changed & BIT_ULL(i)) {
+                    led_hw_sync(i, state & BIT_ULL(i));
+                    WRITE_ONCE(led_changed_ns[i], now);
+                    smp_mb__before_atomic();
+                    atomic_inc(&led_seq[i]);
+                }
+            }
+            atomic_inc(&led_unpublished);
+        }
+        spin_unlock_irqrestore(&led_lock, flags);
+    }
+
+    if (changed) {
+        led_publish();
+    }
+    state = led_state_read();
+    trace_led_update(mask, state, changed);
+
+    return state;
+}
+
+static u64 led_update(u64 mask, u64 value)
+{
+    return led_change(mask, value, false);
 }
 
 /****************************************************************************/
-/* File write operations						                            */
+/* Pattern timer, shows the next frame and programs the following deadline */
 /****************************************************************************/
 
-static ssize_t led_write(struct file *file_ptr, const char __user *user_buffer, size_t size, loff_t *pos)
+static enum hrtimer_restart led_pattern_tick(struct hrtimer *timer)
 {
-    int major, minor;
-    char msgBuffer[MAX_MSG_SIZE];
-    char led_value;
+    const struct led_frame *f;
+    ktime_t deadline = hrtimer_get_expires(timer);
+    ktime_t next;
+    s64 err;
 
-    /* Get major and minor number */
-    major = MAJOR(file_ptr->f_path.dentry->d_inode->i_rdev);
-    minor = MINOR(file_ptr->f_path.dentry->d_inode->i_rdev);
+    err = ktime_to_ns(ktime_sub(ktime_get(), deadline));
+    f = &pattern_frames[pattern_stat.frame];
+    led_update(led_all_mask, f->mask);
+    next = ktime_add_ns(deadline, (u64) f->duration_us * NSEC_PER_USEC);
 
-    /* Check size of user message */
-    if (size > MAX_MSG_SIZE) {
+    spin_lock(&pattern_lock);
+    pattern_stat.frames_shown++;
+    pattern_stat.err_last_ns = err;
+    pattern_stat.err_sum_ns += err > 0 ? err : 0;
+    if (err > pattern_stat.err_max_ns) {
+        pattern_stat.err_max_ns = err;
+    }
+    if (err > (s64) f->duration_us * NSEC_PER_USEC) {
+        pattern_stat.late_frames++;
+    }
+    if (++pattern_stat.frame == pattern_count) {
+        pattern_stat.frame = 0;
+        pattern_stat.loop++;
+        if (pattern_loops != 0 && pattern_stat.loop >= pattern_loops) {
+            pattern_stat.running = 0;
+            spin_unlock(&pattern_lock);
+            return HRTIMER_NORESTART;
+        }
+    }
+    spin_unlock(&pattern_lock);
+
+    hrtimer_set_expires(timer, next);
+    return HRTIMER_RESTART;
+}
+
+/****************************************************************************/
+/* Stop a running pattern, called with pattern_mutex held		    */
+/****************************************************************************/
+
+static void led_pattern_stop(void)
+{
+    hrtimer_cancel(&pattern_timer);
+
+    spin_lock_irq(&pattern_lock);
+    pattern_stat.running = 0;
+    spin_unlock_irq(&pattern_lock);
+
+    kfree(pattern_frames);
+    pattern_frames = NULL;
+}
+
+/****************************************************************************/
+/* Copy a pattern from userspace and start it, replacing a running one	    */
+/****************************************************************************/
+
+static int led_pattern_start(const struct led_pattern *pat)
+{
+    struct led_frame *frames;
+    u32 i;
+
+    if (pat->count == 0 || pat->count > LED_PATTERN_MAX_FRAMES) {
         return -EINVAL;
     }
+    frames = memdup_user((const void __user *) (uintptr_t) pat->frames,
+                         pat->count * sizeof(*frames));
+    if (IS_ERR(frames)) {
+        return PTR_ERR(frames);
+    }
+    for (i=0; i<pat->count; i++) {
+        if (frames[i].duration_us < LED_PATTERN_MIN_US || (frames[i].mask & ~led_all_mask)) {
+            kfree(frames);
+            return -EINVAL;
+        }
+    }
 
-    if (copy_from_user(msgBuffer, user_buffer, size) != 0) {
-        return -EFAULT;
+    mutex_lock(&pattern_mutex);
+    led_pattern_stop();
+
+    pattern_frames = frames;
+    pattern_count  = pat->count;
+    pattern_loops  = pat->loops;
+    memset(&pattern_stat, 0, sizeof(pattern_stat));
+    pattern_stat.running = 1;
+
+    /* The first frame is due now */
+    hrtimer_start(&pattern_timer, ktime_get(), HRTIMER_MODE_ABS);
+    mutex_unlock(&pattern_mutex);
+    return 0;
+}
+
+/****************************************************************************/
+/* Build the sorted edge table from the duties, pwm_lock held		    */
+/****************************************************************************/
+
+static void led_pwm_build(void)
+{
+    u64 old_mask = pwm_on_mask;
+    u64 offset;
+    int i, j;
+
+    pwm_period_ns = NSEC_PER_SEC / pwm_freq;
+    pwm_on_mask   = 0;
+    pwm_edges     = 0;
+
+    for (i=0; i<num_leds; i++) {
+        if (pwm_duty[i] == 0) {
+            continue;
+        }
+        pwm_on_mask |= BIT_ULL(i);
+        if (pwm_duty[i] >= LED_PWM_DUTY_MAX) {
+            continue;
+        }
+
+        /* Insert the off edge sorted, equal offsets share one edge */
+        offset = div_u64(pwm_period_ns * pwm_duty[i], LED_PWM_DUTY_MAX);
+        for (j=0; j<pwm_edges && pwm_edge[j].offset_ns < offset; j++) {
+            ;
+        }
+        if (j < pwm_edges && pwm_edge[j].offset_ns == offset) {
+            pwm_edge[j].off_mask |= BIT_ULL(i);
+            continue;
+        }
+        memmove(&pwm_edge[j + 1], &pwm_edge[j], (pwm_edges - j) * sizeof(pwm_edge[0]));
+        pwm_edge[j].offset_ns = offset;
+        pwm_edge[j].off_mask  = BIT_ULL(i);
+        pwm_edges++;
     }
 
-    /* Get command for the leds from the user  */
-    if (strncmp(msgBuffer, "on", strlen("on")) == 0) {
-        led_value = ON;
-        printk(KERN_INFO "Info: LED1 on!\n");
-    } else if (strncmp(msgBuffer, "off", strlen("off")) == 0) {
-        led_value = OFF;
-        printk(KERN_INFO "Info: LED1 off!\n");
+    /* LEDs that left the PWM end up off */
+    if (old_mask & ~pwm_on_mask) {
+        led_update(old_mask & ~pwm_on_mask, 0);
+    }
+    pwm_stats.freq_hz  = pwm_freq;
+    pwm_stats.channels = hweight64(pwm_on_mask);
+    pwm_dirty = false;
+}
+
+/****************************************************************************/
+/* PWM timer, runs the due edge and programs the next one		    */
+/****************************************************************************/
+
+static enum hrtimer_restart led_pwm_tick(struct hrtimer *timer)
+{
+    u64 t0 = ktime_get_ns();
+    u64 deadline = ktime_to_ns(hrtimer_get_expires(timer));
+    u64 next, cpu;
+    s64 late = (s64) (t0 - deadline);
+
+    spin_lock(&pwm_lock);
+    if (pwm_next == 0) {
+        if (pwm_dirty) {
+            led_pwm_build();
+        }
+        if (pwm_on_mask == 0) {
+            pwm_running = false;
+            spin_unlock(&pwm_lock);
+            return HRTIMER_NORESTART;
+        }
+        pwm_period_start = deadline;
+        led_update(pwm_on_mask, pwm_on_mask);
+        pwm_stats.periods++;
     } else {
-        return size;
+        led_update(pwm_edge[pwm_next - 1].off_mask, 0);
     }
 
-    /* Turn led on or off */
-    gpio_set_value(leds[minor], led_value);
-    return size ;
+    if (pwm_next < pwm_edges) {
+        next = pwm_period_start + pwm_edge[pwm_next].offset_ns;
+        pwm_next++;
+    } else {
+        next = pwm_period_start + pwm_period_ns;
+        pwm_next = 0;
+    }
+
+    cpu = ktime_get_ns() - t0;
+    pwm_stats.edges++;
+    pwm_stats.cpu_ns += cpu;
+    if (cpu > pwm_stats.cpu_max_ns) {
+        pwm_stats.cpu_max_ns = cpu;
+    }
+    pwm_stats.late_sum_ns += late > 0 ? late : 0;
+    if (late > pwm_stats.late_max_ns) {
+        pwm_stats.late_max_ns = late;
+    }
+    spin_unlock(&pwm_lock);
+
+    hrtimer_set_expires(timer, ns_to_ktime(next));
+    return HRTIMER_RESTART;
 }
 
 /****************************************************************************/
-/* File operations implemented by this driver				                */
+/* Set the duty of the LEDs in mask, starts the PWM if needed		    */
 /****************************************************************************/
 
-static struct file_operations led_fops = {
-    .owner = THIS_MODULE,
-    .open = led_open,
-    .release = led_close,
-    .read = led_read,
-    .write = led_write
-};
+static int led_pwm_set_duty(u64 mask, u32 duty)
+{
+    int i;
+
+    if (duty > LED_PWM_DUTY_MAX) {
+        return -EINVAL;
+    }
+
+    spin_lock_irq(&pwm_lock);
+    for (i=0; i<num_leds; i++) {
+        if (mask & BIT_ULL(i)) {
+            pwm_duty[i] = duty;
+        }
+    }
+    pwm_dirty = true;
+    if (!pwm_running && duty > 0) {
+        pwm_running  = true;
+        pwm_next     = 0;
+        pwm_start_ns = ktime_get_ns();
+        memset(&pwm_stats, 0, sizeof(pwm_stats));
+        hrtimer_start(&pwm_timer, ktime_get(), HRTIMER_MODE_ABS);
+    }
+    spin_unlock_irq(&pwm_lock);
+    return 0;
+}
 
 /****************************************************************************/
-/* Module initialization (Constructor)					                    */
+/* Queue timer, executes all due commands and rearms for the next one	    */
 /****************************************************************************/
 
-static int __init led_init(void)
+static enum hrtimer_restart led_queue_tick(struct hrtimer *timer)
 {
-    int ret,i;
-    struct device *dev_ret;
+    struct led_queue *q = container_of(timer, struct led_queue, timer);
+    struct led_queue_result *res;
+    u64 now;
 
-    /* Inform user */
-    printk(KERN_INFO "\nInfo: led_driver_single registered!\n");
-    printk(KERN_INFO "Info: %s V%s\n\n", MODULE_NAME, LED_DRIVER_VER);
+    spin_lock(&q->lock);
+    while (q->count > 0 && q->cmd[0].deadline_ns <= ktime_get_ns()) {
+        led_update(q->cmd[0].mask, q->cmd[0].value);
+        now = ktime_get_ns();
 
-    /* Try to request the gpio for L1 on the BBB-BFH-CAPE */
-    for (i=0; i<HOW_MANY_MINORS; i++) {
-        if ((ret = gpio_request(leds[i], "LED1")) < 0) {
-            return ret;
+        /* Record the result, the oldest one is lost if nobody fetched it */
+        if (q->res_count == LED_QUEUE_RESULTS) {
+            q->res_head = (q->res_head + 1) % LED_QUEUE_RESULTS;
+            q->res_count--;
+            q->stats.lost_results++;
         }
-    }
+        res = &q->result[(q->res_head + q->res_count++) % LED_QUEUE_RESULTS];
+        res->id          = q->cmd[0].id;
+        res->reserved    = 0;
+        res->deadline_ns = q->cmd[0].deadline_ns;
+        res->done_ns     = now;
+        res->late_ns     = (s64) (now - q->cmd[0].deadline_ns);
 
-    /* Set the gpio of L1 on the BBB-BFH-CAPE as output */
-    for (i=0; i<HOW_MANY_MINORS; i++) {
-        if ((ret = gpio_direction_output(leds[i], OFF)) < 0) {
-            return ret;
+        q->stats.executed++;
+        q->stats.late_sum_ns += res->late_ns;
+        if (res->late_ns > q->stats.late_max_ns) {
+            q->stats.late_max_ns = res->late_ns;
         }
+
+        memmove(&q->cmd[0], &q->cmd[1], --q->count * sizeof(q->cmd[0]));
     }
 
-    /* Allocates a range of char device numbers */
-    if ((ret = alloc_chrdev_region(&first_dev, FIRTS_MINOR_NR, HOW_MANY_MINORS, MODULE_NAME)) < 0) {
-        return ret;
+    /* Restarting from the callback keeps a single place that arms the timer */
+    if (q->count > 0) {
+        hrtimer_start(&q->timer, ns_to_ktime(q->cmd[0].deadline_ns), HRTIMER_MODE_ABS);
     }
+    spin_unlock(&q->lock);
 
-    /* Create a struct class pointer to be used in device_create() */
-    if (IS_ERR(dev_class = class_create(THIS_MODULE, MODULE_NAME))) {
-        unregister_chrdev_region(first_dev, HOW_MANY_MINORS);
-        return PTR_ERR(dev_class);
+    return HRTIMER_NORESTART;
+}
+
+/****************************************************************************/
+/* Insert a command sorted by deadline, equal deadlines keep their order   */
+/****************************************************************************/
+
+static int led_queue_add(struct led_queue *q, const struct led_timed_cmd *cmd)
+{
+    u32 pos;
+
+    if (cmd->mask == 0 || (cmd->mask & ~q->allowed)) {
+        return -EINVAL;
     }
 
-    /* Create device in sysfs and register it to the specified class */
-    for (i=0; i<HOW_MANY_MINORS; i++) {
-        if (IS_ERR(dev_ret = device_create(dev_class, NULL, MKDEV(MAJOR(first_dev), MINOR(first_dev) + i), NULL, DEV_NODE_NAME, i))) {
-            class_destroy(dev_class);
-            unregister_chrdev_region(first_dev, HOW_MANY_MINORS);
-            return PTR_ERR(dev_ret);
-        }
+    spin_lock_irq(&q->lock);
+    if (q->count == LED_QUEUE_DEPTH) {
+        spin_unlock_irq(&q->lock);
+        return -ENOSPC;
     }
-    /* Initializes cdev, remembering fops, making it ready to add to the system */
-    cdev_init(&char_dev, &led_fops);
+    for (pos = q->count; pos > 0 && q->cmd[pos - 1].deadline_ns > cmd->deadline_ns; pos--) {
+        ;
+    }
+    memmove(&q->cmd[pos + 1], &q->cmd[pos], (q->count - pos) * sizeof(q->cmd[0]));
+    q->cmd[pos] = *cmd;
+    q->count++;
 
-    /* Adds the device represented by char_dev to the system */
-    if ((ret = cdev_add(&char_dev, first_dev, HOW_MANY_MINORS)) < 0) {
-        device_destroy(dev_class, first_dev);
-        class_destroy(dev_class);
-        unregister_chrdev_region(first_dev, HOW_MANY_MINORS);
-        return ret;
+    /* A new earliest deadline moves the timer */
+    if (pos == 0) {
+        hrtimer_start(&q->timer, ns_to_ktime(cmd->deadline_ns), HRTIMER_MODE_ABS);
     }
+    spin_unlock_irq(&q->lock);
     return 0;
 }
 
 /****************************************************************************/
-/* Module cleanup (Destructor)						                        */
+/* Queue ioctls of one node						    */
 /****************************************************************************/
 
-static void __exit led_exit(void)
+static long led_queue_ioctl(struct led_queue *q, unsigned int cmd, void __user *argp)
 {
-    int i;
+    struct led_timed_cmd    tcmd;
+    struct led_queue_result res;
+    struct led_queue_stats  stats;
 
-    /* Remove char_dev from the system */
-    cdev_del(&char_dev);
+    switch (cmd) {
+    case LED_IOC_QUEUE_ADD:
+        if (copy_from_user(&tcmd, argp, sizeof(tcmd)) != 0) {
+            return -EFAULT;
+        }
+        return led_queue_add(q, &tcmd);
 
-    /* Unregisters and cleans up devices created with a call to device_create */
-    for (i=0; i<HOW_MANY_MINORS; i++) {
-        device_destroy(dev_class, MKDEV(MAJOR(first_dev), MINOR(first_dev) + i));
+    case LED_IOC_QUEUE_FLUSH:
+        spin_lock_irq(&q->lock);
+        q->count = 0;
+        spin_unlock_irq(&q->lock);
+        return 0;
+
+    case LED_IOC_QUEUE_RESULT:
+        spin_lock_irq(&q->lock);
+        if (q->res_count == 0) {
+            spin_unlock_irq(&q->lock);
+            return -EAGAIN;
+        }
+        res = q->result[q->res_head];
+        q->res_head = (q->res_head + 1) % LED_QUEUE_RESULTS;
+        q->res_count--;
+        spin_unlock_irq(&q->lock);
+        return copy_to_user(argp, &res, sizeof(res)) ? -EFAULT : 0;
+
+    case LED_IOC_QUEUE_STATS:
+        spin_lock_irq(&q->lock);
+        stats = q->stats;
+        stats.pending = q->count;
+        stats.results = q->res_count;
+        spin_unlock_irq(&q->lock);
+        return copy_to_user(argp, &stats, sizeof(stats)) ? -EFAULT : 0;
+
+    default:
+        return -ENOTTY;
     }
+}
 
-    /* Destroy an existing class */
-    class_destroy(dev_class);
+/****************************************************************************/
+/* Statistics of a read or write, t0 is 0 unless latency_enable is set     */
+/****************************************************************************/
 
-    /* Unregister a range of device numbers */
-    unregister_chrdev_region(first_dev, HOW_MANY_MINORS);
+static u64 led_stats_begin(void)
+{
+    return READ_ONCE(led_lat_enable) ? ktime_get_ns() : 0;
+}
 
-    /* Release previously requested gpios */
-    for (i=0; i<HOW_MANY_MINORS; i++) {
-        gpio_free(leds[i]);
+static void led_stats_io(int minor, int op, ssize_t ret, u64 t0)
+{
+    u64 lat;
+    int k;
+
+    if (op == LED_OP_READ) {
+        this_cpu_inc(led_pcpu[minor].reads);
+    } else {
+        this_cpu_inc(led_pcpu[minor].writes);
+    }
+    if (ret < 0) {
+        this_cpu_inc(led_pcpu[minor].errors);
+    } else if (op == LED_OP_READ) {
+        this_cpu_add(led_pcpu[minor].read_bytes, ret);
+    } else {
+        this_cpu_add(led_pcpu[minor].write_bytes, ret);
     }
 
+    if (t0) {
+        lat = ktime_get_ns() - t0;
+        k = lat ? fls64(lat) - 1 : 0;
+        this_cpu_inc(led_pcpu[minor].lat[op][min(k, LED_LAT_HIST - 1)]);
+    }
+}
+
+/****************************************************************************/
+/* debugfs stats, the per-CPU counters summed up			    */
+/****************************************************************************/
+
+static int led_stats_show(struct seq_file *m, void *v)
+{
+    static const char *op_name[LED_OPS] = { "read", "write" };
+    struct led_minor_stats sum;
+    struct led_minor_stats *st;
+    int minor, cpu, op, k;
+
+    for (minor=0; minor<NUM_MINORS; minor++) {
+        memset(&sum, 0, sizeof(sum));
+        for_each_possible_cpu(cpu) {
+            st = per_cpu_ptr(&led_pcpu[minor], cpu);
+            sum.opens       += st->opens;
+            sum.closes      += st->closes;
+            sum.reads       += st->reads;
+            sum.writes      += st->writes;
+            sum.read_bytes  += st->read_bytes;
+            sum.write_bytes += st->write_bytes;
+            sum.errors      += st->errors;
+            for (op=0; op<LED_OPS; op++) {
+                for (k=0; k<LED_LAT_HIST; k++) {
+                    sum.lat[op][k] += st->lat[op][k];
+                }
+            }
+        }
+
+        if (minor == LED_AGGR_MINOR) {
+            seq_printf(m, "%s:", LED_AGGR_NODE_NAME);
+        } else {
+            seq_printf(m, DEV_NODE_NAME ":", minor);
+        }
+        seq_printf(m, " opens %llu closes %llu reads %llu writes %llu "
+                   "read_bytes %llu write_bytes %llu errors %llu\n",
+                   sum.opens, sum.closes, sum.reads, sum.writes,
+                   sum.read_bytes, sum.write_bytes, sum.errors);
+
+        for (op=0; op<LED_OPS; op++) {
+            seq_printf(m, "  %s ns:", op_name[op]);
+            for (k=0; k<LED_LAT_HIST; k++) {
+                if (sum.lat[op][k]) {
+                    seq_printf(m, " %u:%u", 1u << k, sum.lat[op][k]);
+                }
+            }
+            seq_puts(m, "\n");
+        }
+    }
+    return 0;
+}
+
+static int led_stats_open(struct inode *inode, struct file *file_ptr)
+{
+    return single_open(file_ptr, led_stats_show, NULL);
+}
+
+static const struct file_operations led_stats_fops = {
+    .owner = THIS_MODULE,
+    .open = led_stats_open,
+    .read = seq_read,
+    .llseek = seq_lseek,
+    .release = single_release
+};
+
+/****************************************************************************/
+/* File open								                                */
+/****************************************************************************/
+
+static int led_open(struct inode *inode, struct file *file_ptr)
+{
+    struct led_file *lf;
+    int minor;
+
+    minor = iminor(inode);
+    trace_led_open(minor);
+    this_cpu_inc(led_pcpu[minor].opens);
+
+    /* Changes before the open are not reported */
+    if ((lf = kzalloc(sizeof(*lf), GFP_KERNEL)) == NULL) {
+        this_cpu_inc(led_pcpu[minor].errors);
+        return -ENOMEM;
+    }
+    lf->minor = minor;
+    lf->seen  = atomic_read(&led_seq[minor]);
+    file_ptr->private_data = lf;
+    return 0;
+}
+
+/****************************************************************************/
+/* File close operations						                            */
+/****************************************************************************/
+
+static int led_close(struct inode *inode, struct file *file_ptr)
+{
+    int minor;
+
+    /* Get minor number */
+    minor = iminor(inode);
+    trace_led_close(minor);
+    this_cpu_inc(led_pcpu[minor].closes);
+    kfree(file_ptr->private_data);
+    return 0;
+}
+
+/****************************************************************************/
+/* Event mode read, one struct led_event per call			    */
+/****************************************************************************/
+
+static ssize_t led_read_event(struct file *file_ptr, struct led_file *lf, char __user *user_buffer, size_t count)
+{
+    struct led_event ev;
+    int ret;
+
+    if (count < sizeof(ev)) {
+        return -EINVAL;
+    }
+    if (atomic_read(&led_seq[lf->minor]) == lf->seen) {
+        if (file_ptr->f_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        ret = wait_event_interruptible(led_wait, atomic_read(&led_seq[lf->minor]) != lf->seen);
+        if (ret) {
+            return ret;
+        }
+    }
+
+    /* Count and time of this node's change, again if it changed meanwhile */
+    do {
+        ev.seq        = atomic_read(&led_seq[lf->minor]);
+        smp_rmb();
+        ev.changed_ns = READ_ONCE(led_changed_ns[lf->minor]);
+        ev.mask       = led_state_read();
+        smp_rmb();
+    } while (ev.seq != atomic_read(&led_seq[lf->minor]));
+    ev.reserved = 0;
+
+    if (copy_to_user(user_buffer, &ev, sizeof(ev)) != 0) {
+        return -EFAULT;
+    }
+    lf->seen = ev.seq;
+    return sizeof(ev);
+}
+
+/****************************************************************************/
+/* poll, readable once the node changed since the last read		    */
+/****************************************************************************/
+
+static unsigned int led_poll(struct file *file_ptr, poll_table *wait)
+{
+    struct led_file *lf = file_ptr->private_data;
+
+    poll_wait(file_ptr, &led_wait, wait);
+    return atomic_read(&led_seq[lf->minor]) != lf->seen ? POLLIN | POLLRDNORM : 0;
+}
+
+/****************************************************************************/
+/* File read operations							                            */
+/****************************************************************************/
+
+static ssize_t led_do_read(struct file *file_ptr, char __user *user_buffer, size_t count, loff_t *f_pos)
+{
+    size_t len = count, status_length;
+    ssize_t retval = 0;
+    unsigned long ret = 0;
+    struct led_file *lf = file_ptr->private_data;
+    int minor = lf->minor;
+    char *onOff;
+
+    if (lf->events) {
+        return led_read_event(file_ptr, lf, user_buffer, count);
+    }
+
+    /* A read reports the current state, poll() waits for the next change */
+    lf->seen = atomic_read(&led_seq[minor]);
+
+    /* The aggregate node returns all LEDs as one binary word */
+    if (minor == LED_AGGR_MINOR) {
+        u64 mask;
+
+        if (*f_pos != 0) {
+            return 0;
+        }
+        if (count < sizeof(mask)) {
+            return -EINVAL;
+        }
+        mask = led_state_read();
+        if (copy_to_user(user_buffer, &mask, sizeof(mask)) != 0) {
+            return -EFAULT;
+        }
+        *f_pos += sizeof(mask);
+        return sizeof(mask);
+    }
+
+    /* Get led status from the cached state */
+    if (test_bit(minor, led_bits)) {
+        onOff = "\non\n";
+    } else {
+        onOff = "\noff\n";
+    }
+    status_length = strlen(onOff);
+
+    /* Check and adjust limits */
+    if (*f_pos >= status_length) {
+        return 0;
+    }
+    if (*f_pos + count > status_length) {
+        len = status_length - *f_pos;
+    }
+
+    /* Copy message to user */
+    ret = copy_to_user(user_buffer, onOff, len);
+    *f_pos += len - ret;
+    retval = len - ret;
+    return retval;
+}
+
+/****************************************************************************/
+/* Apply a binary batch. The entries are copied in chunks and folded into  */
+/* one mask/value pair, the LEDs change once after the whole batch is valid */
+/****************************************************************************/
+
+#define LED_BATCH_CHUNK		32
+
+static ssize_t led_write_batch(const char __user *user_buffer, size_t size)
+{
+    struct led_batch_hdr hdr;
+    const char __user *p = user_buffer + sizeof(hdr);
+    u64 mask = 0, value = 0;
+    size_t entry_size, left, n, i;
+
+    if (copy_from_user(&hdr, user_buffer, sizeof(hdr)) != 0) {
+        return -EFAULT;
+    }
+    if (hdr.count == 0 || hdr.count > LED_BATCH_MAX) {
+        return -EINVAL;
+    }
+
+    switch (hdr.type) {
+    case LED_BATCH_SET:
+        entry_size = sizeof(struct led_batch_set);
+        break;
+    case LED_BATCH_UPDATE:
+        entry_size = sizeof(struct led_mask_update);
+        break;
+    default:
+        return -EINVAL;
+    }
+    if (size != sizeof(hdr) + hdr.count * entry_size) {
+        return -EINVAL;
+    }
+
+    for (left = hdr.count; left > 0; left -= n) {
+        n = min_t(size_t, left, LED_BATCH_CHUNK);
+
+        if (hdr.type == LED_BATCH_SET) {
+            struct led_batch_set set[LED_BATCH_CHUNK];
+
+            if (copy_from_user(set, p, n * entry_size) != 0) {
+                return -EFAULT;
+            }
+            for (i=0; i<n; i++) {
+                if (set[i].led >= num_leds) {
+                    return -EINVAL;
+                }
+                mask |= BIT_ULL(set[i].led);
+                if (set[i].on) {
+                    value |= BIT_ULL(set[i].led);
+                } else {
+                    value &= ~BIT_ULL(set[i].led);
+                }
+            }
+        } else {
+            struct led_mask_update upd[LED_BATCH_CHUNK];
+
+            if (copy_from_user(upd, p, n * entry_size) != 0) {
+                return -EFAULT;
+            }
+            for (i=0; i<n; i++) {
+                if (upd[i].mask & ~led_all_mask) {
+                    return -EINVAL;
+                }
+                mask |= upd[i].mask;
+                value = (value & ~upd[i].mask) | (upd[i].value & upd[i].mask);
+            }
+        }
+        p += n * entry_size;
+    }
+
+    led_update(mask, value);
+    return size;
+}
+
+/****************************************************************************/
+/* File write operations						                            */
+/****************************************************************************/
+
+static ssize_t led_do_write(struct file *file_ptr, const char __user *user_buffer, size_t size, loff_t *pos)
+{
+    int minor = ((struct led_file *) file_ptr->private_data)->minor;
+    char msgBuffer[MAX_MSG_SIZE];
+    char led_value;
+
+    /* The aggregate node takes all LEDs as one binary word or a batch */
+    if (minor == LED_AGGR_MINOR) {
+        u64 mask;
+        u32 magic;
+
+        if (size > sizeof(mask)) {
+            if (get_user(magic, (const u32 __user *) user_buffer) != 0) {
+                return -EFAULT;
+            }
+            return magic == LED_BATCH_MAGIC ? led_write_batch(user_buffer, size) : -EINVAL;
+        }
+        if (size != sizeof(mask)) {
+            return -EINVAL;
+        }
+        if (copy_from_user(&mask, user_buffer, sizeof(mask)) != 0) {
+            return -EFAULT;
+        }
+        led_update(led_all_mask, mask);
+        return size;
+    }
+
+    /* Check size of user message */
+    if (size > MAX_MSG_SIZE) {
+        return -EINVAL;
+    }
+
+    if (copy_from_user(msgBuffer, user_buffer, size) != 0) {
+        return -EFAULT;
+    }
+
+    /* Get command for the leds from the user  */
+    if (strncmp(msgBuffer, "on", strlen("on")) == 0) {
+        led_value = ON;
+    } else if (strncmp(msgBuffer, "off", strlen("off")) == 0) {
+        led_value = OFF;
+    } else {
+        return size;
+    }
+
+    /* Turn led on or off */
+    led_update(BIT_ULL(minor), led_value == ON ? BIT_ULL(minor) : 0);
+    return size ;
+}
+
+/****************************************************************************/
+/* read and write entry points, tracing and statistics around the work    */
+/****************************************************************************/
+
+static ssize_t led_read(struct file *file_ptr, char __user *user_buffer, size_t count, loff_t *f_pos)
+{
+    int minor = ((struct led_file *) file_ptr->private_data)->minor;
+    u64 t0 = led_stats_begin();
+    ssize_t ret;
+
+    ret = led_do_read(file_ptr, user_buffer, count, f_pos);
+    led_stats_io(minor, LED_OP_READ, ret, t0);
+    trace_led_read(minor, count, ret);
+    return ret;
+}
+
+static ssize_t led_write(struct file *file_ptr, const char __user *user_buffer, size_t size, loff_t *pos)
+{
+    int minor = ((struct led_file *) file_ptr->private_data)->minor;
+    u64 t0 = led_stats_begin();
+    ssize_t ret;
+
+    ret = led_do_write(file_ptr, user_buffer, size, pos);
+    led_stats_io(minor, LED_OP_WRITE, ret, t0);
+    trace_led_write(minor, size, ret);
+    return ret;
+}
+
+/****************************************************************************/
+/* ioctl operations, bitmask access to all LEDs				    */
+/****************************************************************************/
+
+static long led_ioctl(struct file *file_ptr, unsigned int cmd, unsigned long arg)
+{
+    void __user *argp = (void __user *) arg;
+    struct led_mask_update upd;
+    struct led_pattern pat;
+    struct led_pattern_status stat;
+    struct led_pwm_stats pwm_st;
+    u64 mask;
+    u32 count;
+    int minor = ((struct led_file *) file_ptr->private_data)->minor;
+
+    switch (cmd) {
+    case LED_IOC_GET_MASK:
+        mask = led_state_read();
+        return copy_to_user(argp, &mask, sizeof(mask)) ? -EFAULT : 0;
+
+    case LED_IOC_SET_MASK:
+        if (copy_from_user(&mask, argp, sizeof(mask)) != 0) {
+            return -EFAULT;
+        }
+        led_update(led_all_mask, mask);
+        return 0;
+
+    case LED_IOC_UPDATE:
+        if (copy_from_user(&upd, argp, sizeof(upd)) != 0) {
+            return -EFAULT;
+        }
+        led_update(upd.mask, upd.value);
+        return 0;
+
+    case LED_IOC_GET_COUNT:
+        count = num_leds;
+        return copy_to_user(argp, &count, sizeof(count)) ? -EFAULT : 0;
+
+    case LED_IOC_PATTERN_START:
+        if (copy_from_user(&pat, argp, sizeof(pat)) != 0) {
+            return -EFAULT;
+        }
+        return led_pattern_start(&pat);
+
+    case LED_IOC_PATTERN_STOP:
+        mutex_lock(&pattern_mutex);
+        led_pattern_stop();
+        mutex_unlock(&pattern_mutex);
+        return 0;
+
+    case LED_IOC_QUEUE_ADD:
+    case LED_IOC_QUEUE_FLUSH:
+    case LED_IOC_QUEUE_RESULT:
+    case LED_IOC_QUEUE_STATS:
+        return led_queue_ioctl(&led_queues[minor], cmd, argp);
+
+    case LED_IOC_EVENTS:
+        if (get_user(count, (u32 __user *) argp) != 0) {
+            return -EFAULT;
+        }
+        ((struct led_file *) file_ptr->private_data)->events = count != 0;
+        return 0;
+
+    case LED_IOC_PWM_SET_DUTY:
+        if (get_user(count, (u32 __user *) argp) != 0) {
+            return -EFAULT;
+        }
+        return led_pwm_set_duty(minor == LED_AGGR_MINOR ? led_all_mask : BIT_ULL(minor), count);
+
+    case LED_IOC_PWM_SET_FREQ:
+        if (get_user(count, (u32 __user *) argp) != 0) {
+            return -EFAULT;
+        }
+        if (count < LED_PWM_FREQ_MIN || count > LED_PWM_FREQ_MAX) {
+            return -EINVAL;
+        }
+        spin_lock_irq(&pwm_lock);
+        pwm_freq  = count;
+        pwm_dirty = true;
+        spin_unlock_irq(&pwm_lock);
+        return 0;
+
+    case LED_IOC_PWM_STATS:
+        spin_lock_irq(&pwm_lock);
+        pwm_st = pwm_stats;
+        pwm_st.freq_hz    = pwm_freq;
+        pwm_st.elapsed_ns = pwm_running ? ktime_get_ns() - pwm_start_ns : 0;
+        spin_unlock_irq(&pwm_lock);
+        return copy_to_user(argp, &pwm_st, sizeof(pwm_st)) ? -EFAULT : 0;
+
+    case LED_IOC_PATTERN_STATUS:
+        spin_lock_irq(&pattern_lock);
+        stat = pattern_stat;
+        spin_unlock_irq(&pattern_lock);
+        return copy_to_user(argp, &stat, sizeof(stat)) ? -EFAULT : 0;
+
+    default:
+        return -ENOTTY;
+    }
+}
+
+/****************************************************************************/
+/* mmap of the read-only status page					    */
+/****************************************************************************/
+
+static int led_mmap(struct file *file_ptr, struct vm_area_struct *vma)
+{
+    if (vma->vm_pgoff != 0 || vma->vm_end - vma->vm_start > PAGE_SIZE) {
+        return -EINVAL;
+    }
+    if (vma->vm_flags & VM_WRITE) {
+        return -EPERM;
+    }
+    vma->vm_flags &= ~VM_MAYWRITE;
+    vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+
+    return vm_insert_page(vma, vma->vm_start, virt_to_page(led_status));
+}
+
+/****************************************************************************/
+/* File operations implemented by this driver				                */
+/****************************************************************************/
+
+static struct file_operations led_fops = {
+    .owner = THIS_MODULE,
+    .open = led_open,
+    .release = led_close,
+    .read = led_read,
+    .write = led_write,
+    .unlocked_ioctl = led_ioctl,
+    .mmap = led_mmap,
+    .poll = led_poll
+};
+
+/****************************************************************************/
+/* Buttons: current level, 1 = pressed					    */
+/****************************************************************************/
+
+static int btn_level(const struct btn *b)
+{
+    return gpio_get_value(buttons[b->index]) == BTN_PRESSED;
+}
+
+/****************************************************************************/
+/* Apply the reflex of a button and account its latency, lock held	    */
+/****************************************************************************/
+
+static void btn_reflex_apply(struct btn *b, int pressed, u64 ts)
+{
+    struct btn_reflex_stats *st = &b->reflex_stats;
+    u64 leds = b->reflex.leds;
+    u64 lat;
+    int k;
+
+    switch (b->reflex.mode) {
+    case BTN_REFLEX_DIRECT:
+        led_update(leds, pressed ? leds : 0);
+        break;
+    case BTN_REFLEX_INVERTED:
+        led_update(leds, pressed ? 0 : leds);
+        break;
+    case BTN_REFLEX_TOGGLE:
+        if (!pressed) {
+            return;
+        }
+        led_change(leds, 0, true);
+        break;
+    default:
+        return;
+    }
+
+    lat = ktime_get_ns() - ts;
+    k = lat ? fls64(lat) - 1 : 0;
+    st->hist[min(k, BTN_REFLEX_HIST - 1)]++;
+    st->count++;
+    st->sum_ns += lat;
+    if (lat > st->max_ns) {
+        st->max_ns = lat;
+    }
+}
+
+/****************************************************************************/
+/* Queue an event and take it as the debounced state, lock held	    */
+/****************************************************************************/
+
+static void btn_report(struct btn *b, int pressed, u64 ts)
+{
+    struct btn_event ev;
+
+    btn_reflex_apply(b, pressed, ts);
+
+    ev.ts_ns   = ts;
+    ev.button  = b->index;
+    ev.pressed = pressed;
+
+    b->pressed = pressed;
+    if (!kfifo_put(&b->fifo, ev)) {
+        b->lost++;
+    }
+    wake_up_interruptible(&b->wait);
+}
+
+/****************************************************************************/
+/* Edge interrupt, leading edge debounce: report the first edge at once    */
+/* and ignore the bouncing until the lockout timer expires		    */
+/****************************************************************************/
+
+static irqreturn_t btn_irq(int irq, void *dev_id)
+{
+    struct btn *b = dev_id;
+    u64 ts = ktime_get_ns();
+    int pressed;
+
+    spin_lock(&b->lock);
+    if (!b->lockout) {
+        pressed = btn_level(b);
+        if (pressed != b->pressed) {
+            btn_report(b, pressed, ts);
+            b->lockout = true;
+            hrtimer_start(&b->timer, ns_to_ktime((u64) debounce_ms * NSEC_PER_MSEC), HRTIMER_MODE_REL);
+        }
+    }
+    spin_unlock(&b->lock);
+
+    return IRQ_HANDLED;
+}
+
+/****************************************************************************/
+/* End of the lockout, a level that differs now was missed while locked    */
+/****************************************************************************/
+
+static enum hrtimer_restart btn_debounce_tick(struct hrtimer *timer)
+{
+    struct btn *b = container_of(timer, struct btn, timer);
+    enum hrtimer_restart ret = HRTIMER_NORESTART;
+    int pressed;
+
+    spin_lock(&b->lock);
+    pressed = btn_level(b);
+    if (pressed != b->pressed) {
+        btn_report(b, pressed, ktime_get_ns());
+        hrtimer_forward_now(timer, ns_to_ktime((u64) debounce_ms * NSEC_PER_MSEC));
+        ret = HRTIMER_RESTART;
+    } else {
+        b->lockout = false;
+    }
+    spin_unlock(&b->lock);
+
+    return ret;
+}
+
+/****************************************************************************/
+/* Button file operations						    */
+/****************************************************************************/
+
+static int btn_open(struct inode *inode, struct file *file_ptr)
+{
+    file_ptr->private_data = &btns[iminor(inode)];
+    return 0;
+}
+
+static ssize_t btn_read(struct file *file_ptr, char __user *user_buffer, size_t count, loff_t *f_pos)
+{
+    struct btn *b = file_ptr->private_data;
+    struct btn_event ev;
+    size_t done = 0;
+    int got, ret;
+
+    if (count < sizeof(ev)) {
+        return -EINVAL;
+    }
+
+    /* Several readers share the queue, wait again if another one was first */
+    while (done == 0) {
+        if (kfifo_is_empty(&b->fifo)) {
+            if (file_ptr->f_flags & O_NONBLOCK) {
+                return -EAGAIN;
+            }
+            ret = wait_event_interruptible(b->wait, !kfifo_is_empty(&b->fifo));
+            if (ret) {
+                return ret;
+            }
+        }
+        while (done + sizeof(ev) <= count) {
+            spin_lock_irq(&b->lock);
+            got = kfifo_get(&b->fifo, &ev);
+            spin_unlock_irq(&b->lock);
+            if (!got) {
+                break;
+            }
+            if (copy_to_user(user_buffer + done, &ev, sizeof(ev)) != 0) {
+                return done ? done : -EFAULT;
+            }
+            done += sizeof(ev);
+        }
+    }
+    return done;
+}
+
+static unsigned int btn_poll(struct file *file_ptr, poll_table *wait)
+{
+    struct btn *b = file_ptr->private_data;
+
+    poll_wait(file_ptr, &b->wait, wait);
+    return kfifo_is_empty(&b->fifo) ? 0 : POLLIN | POLLRDNORM;
+}
+
+static long btn_ioctl(struct file *file_ptr, unsigned int cmd, unsigned long arg)
+{
+    struct btn *b = file_ptr->private_data;
+    void __user *argp = (void __user *) arg;
+    struct btn_state st;
+    struct btn_reflex reflex;
+    struct btn_reflex_stats stats;
+
+    switch (cmd) {
+    case BTN_IOC_GET_STATE:
+        spin_lock_irq(&b->lock);
+        st.pressed = b->pressed;
+        st.queued  = kfifo_len(&b->fifo);
+        st.lost    = b->lost;
+        spin_unlock_irq(&b->lock);
+        st.debounce_ms = debounce_ms;
+        return copy_to_user(argp, &st, sizeof(st)) ? -EFAULT : 0;
+
+    case BTN_IOC_SET_REFLEX:
+        if (copy_from_user(&reflex, argp, sizeof(reflex)) != 0) {
+            return -EFAULT;
+        }
+        if (reflex.mode > BTN_REFLEX_TOGGLE || (reflex.leds & ~led_all_mask)) {
+            return -EINVAL;
+        }
+        spin_lock_irq(&b->lock);
+        b->reflex = reflex;
+        memset(&b->reflex_stats, 0, sizeof(b->reflex_stats));
+
+        /* Level mappings follow the button right away */
+        if (reflex.mode == BTN_REFLEX_DIRECT || reflex.mode == BTN_REFLEX_INVERTED) {
+            led_update(reflex.leds, (b->pressed == (reflex.mode == BTN_REFLEX_DIRECT)) ? reflex.leds : 0);
+        }
+        spin_unlock_irq(&b->lock);
+        return 0;
+
+    case BTN_IOC_GET_REFLEX:
+        spin_lock_irq(&b->lock);
+        reflex = b->reflex;
+        spin_unlock_irq(&b->lock);
+        return copy_to_user(argp, &reflex, sizeof(reflex)) ? -EFAULT : 0;
+
+    case BTN_IOC_REFLEX_STATS:
+        spin_lock_irq(&b->lock);
+        stats = b->reflex_stats;
+        spin_unlock_irq(&b->lock);
+        return copy_to_user(argp, &stats, sizeof(stats)) ? -EFAULT : 0;
+
+    default:
+        return -ENOTTY;
+    }
+}
+
+static struct file_operations btn_fops = {
+    .owner = THIS_MODULE,
+    .open = btn_open,
+    .read = btn_read,
+    .poll = btn_poll,
+    .unlocked_ioctl = btn_ioctl
+};
+
+/****************************************************************************/
+/* Release the first n buttons						    */
+/****************************************************************************/
+
+static void btn_free(int n)
+{
+    while (--n >= 0) {
+        free_irq(btns[n].irq, &btns[n]);
+        hrtimer_cancel(&btns[n].timer);
+        gpio_free(buttons[n]);
+    }
+}
+
+/****************************************************************************/
+/* Claim the button gpios and interrupts, create /dev/btn0..3		    */
+/****************************************************************************/
+
+static int btn_init(void)
+{
+    struct device *dev_ret;
+    struct btn *b;
+    int ret, i;
+
+    for (i=0; i<HOW_MANY_BUTTONS; i++) {
+        b = &btns[i];
+        b->index = i;
+        spin_lock_init(&b->lock);
+        init_waitqueue_head(&b->wait);
+        INIT_KFIFO(b->fifo);
+        hrtimer_init(&b->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+        b->timer.function = btn_debounce_tick;
+
+        if ((ret = gpio_request(buttons[i], "BTN")) < 0) {
+            goto err_btn;
+        }
+        if ((ret = gpio_direction_input(buttons[i])) < 0 || (ret = b->irq = gpio_to_irq(buttons[i])) < 0) {
+            gpio_free(buttons[i]);
+            goto err_btn;
+        }
+        b->pressed = btn_level(b);
+        if ((ret = request_irq(b->irq, btn_irq, IRQF_TRIGGER_RISING | IRQF_TRIGGER_FALLING, BTN_MODULE_NAME, b)) < 0) {
+            gpio_free(buttons[i]);
+            goto err_btn;
+        }
+    }
+
+    if ((ret = alloc_chrdev_region(&btn_first_dev, 0, HOW_MANY_BUTTONS, BTN_MODULE_NAME)) < 0) {
+        goto err_btn;
+    }
+    for (i=0; i<HOW_MANY_BUTTONS; i++) {
+        dev_ret = device_create(dev_class, NULL, MKDEV(MAJOR(btn_first_dev), i), NULL, BTN_NODE_NAME, i);
+        if (IS_ERR(dev_ret)) {
+            ret = PTR_ERR(dev_ret);
+            goto err_device;
+        }
+    }
+    cdev_init(&btn_char_dev, &btn_fops);
+    if ((ret = cdev_add(&btn_char_dev, btn_first_dev, HOW_MANY_BUTTONS)) < 0) {
+        goto err_device;
+    }
+    return 0;
+
+err_device:
+    while (--i >= 0) {
+        device_destroy(dev_class, MKDEV(MAJOR(btn_first_dev), i));
+    }
+    unregister_chrdev_region(btn_first_dev, HOW_MANY_BUTTONS);
+    i = HOW_MANY_BUTTONS;
+err_btn:
+    btn_free(i);
+    return ret;
+}
+
+/****************************************************************************/
+/* Remove the button nodes and release the buttons			    */
+/****************************************************************************/
+
+static void btn_exit(void)
+{
+    int i;
+
+    cdev_del(&btn_char_dev);
+    for (i=0; i<HOW_MANY_BUTTONS; i++) {
+        device_destroy(dev_class, MKDEV(MAJOR(btn_first_dev), i));
+    }
+    unregister_chrdev_region(btn_first_dev, HOW_MANY_BUTTONS);
+    btn_free(HOW_MANY_BUTTONS);
+}
+
+/****************************************************************************/
+/* Allocate and free the per LED and per node state			            */
+/****************************************************************************/
+
+static void led_state_free(void)
+{
+    free_percpu(led_pcpu);
+    kfree(pwm_edge);
+    kfree(pwm_duty);
+    kfree(led_queues);
+    kfree(led_changed_ns);
+    kfree(led_seq);
+    kfree(led_label);
+    kfree(led_desc);
+}
+
+static int led_state_alloc(void)
+{
+    led_desc   = kcalloc(num_leds, sizeof(*led_desc), GFP_KERNEL);
+    led_label  = kcalloc(num_leds, sizeof(*led_label), GFP_KERNEL);
+    led_seq    = kcalloc(NUM_MINORS, sizeof(*led_seq), GFP_KERNEL);
+    led_changed_ns = kcalloc(NUM_MINORS, sizeof(*led_changed_ns), GFP_KERNEL);
+    led_queues = kcalloc(NUM_MINORS, sizeof(*led_queues), GFP_KERNEL);
+    pwm_duty   = kcalloc(num_leds, sizeof(*pwm_duty), GFP_KERNEL);
+    pwm_edge   = kcalloc(num_leds, sizeof(*pwm_edge), GFP_KERNEL);
+    led_pcpu   = __alloc_percpu(NUM_MINORS * sizeof(*led_pcpu), __alignof__(*led_pcpu));
+
+    if (!led_desc || !led_label || !led_seq || !led_changed_ns || !led_queues || !pwm_duty || !pwm_edge || !led_pcpu) {
+        led_state_free();
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+/****************************************************************************/
+/* Module initialization (Constructor)					                    */
+/****************************************************************************/
+
+static int __init led_init(void)
+{
+    int ret,i;
+    struct device *dev_ret;
+
+    /* Inform user */
+    printk(KERN_INFO "\nInfo: led_driver_single registered!\n");
+    printk(KERN_INFO "Info: %s V%s\n\n", MODULE_NAME, LED_DRIVER_VER);
+
+    /* The gpios= parameter sets the number of LEDs */
+    if (num_leds == 0 || num_leds > LED_MAX) {
+        printk(KERN_ERR "Error: %u LEDs, 1 to %d supported\n", num_leds, LED_MAX);
+        return -EINVAL;
+    }
+    led_all_mask = (num_leds == LED_MAX) ? ~0ULL : BIT_ULL(num_leds) - 1;
+    if ((ret = led_state_alloc()) < 0) {
+        return ret;
+    }
+
+    /* Try to request the LED gpios, default L1..L4 on the BBB-BFH-CAPE */
+    for (i=0; i<num_leds; i++) {
+        snprintf(led_label[i], sizeof(led_label[i]), DEV_NODE_NAME, i);
+        if ((ret = gpio_request(leds[i], led_label[i])) < 0) {
+            goto err_gpio;
+        }
+    }
+
+    /* Set the LED gpios as output */
+    for (i=0; i<num_leds; i++) {
+        if ((ret = gpio_direction_output(leds[i], OFF)) < 0) {
+            i = num_leds;
+            goto err_gpio;
+        }
+        led_desc[i] = gpio_to_desc(leds[i]);
+    }
+    bitmap_zero(led_bits, LED_MAX);
+
+    /* The status page shared with userspace */
+    if ((led_status = (struct led_status_page *) get_zeroed_page(GFP_KERNEL)) == NULL) {
+        ret = -ENOMEM;
+        i = num_leds;
+        goto err_gpio;
+    }
+    led_status->count = num_leds;
+
+    /* Debugfs statistics are optional */
+    led_debugfs = debugfs_create_dir(MODULE_NAME, NULL);
+    if (!IS_ERR_OR_NULL(led_debugfs)) {
+        debugfs_create_file("stats", 0444, led_debugfs, NULL, &led_stats_fops);
+        debugfs_create_u32("latency_enable", 0644, led_debugfs, &led_lat_enable);
+    }
+
+    /* Pattern timer with absolute deadlines */
+    hrtimer_init(&pattern_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    pattern_timer.function = led_pattern_tick;
+
+    /* Software PWM timer */
+    hrtimer_init(&pwm_timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    pwm_timer.function = led_pwm_tick;
+
+    /* Command queues, one per node */
+    for (i=0; i<NUM_MINORS; i++) {
+        spin_lock_init(&led_queues[i].lock);
+        hrtimer_init(&led_queues[i].timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+        led_queues[i].timer.function = led_queue_tick;
+        led_queues[i].allowed = (i == LED_AGGR_MINOR) ? led_all_mask : BIT_ULL(i);
+    }
+
+    /* Allocates a range of char device numbers, LEDs plus aggregate node */
+    if ((ret = alloc_chrdev_region(&first_dev, FIRTS_MINOR_NR, NUM_MINORS, MODULE_NAME)) < 0) {
+        goto err_stats;
+    }
+
+    /* Create a struct class pointer to be used in device_create() */
+    if (IS_ERR(dev_class = class_create(THIS_MODULE, MODULE_NAME))) {
+        ret = PTR_ERR(dev_class);
+        goto err_region;
+    }
+
+    /* Create device in sysfs and register it to the specified class */
+    for (i=0; i<NUM_MINORS; i++) {
+        if (i == LED_AGGR_MINOR) {
+            dev_ret = device_create(dev_class, NULL, MKDEV(MAJOR(first_dev), MINOR(first_dev) + i), NULL, LED_AGGR_NODE_NAME);
+        } else {
+            dev_ret = device_create(dev_class, NULL, MKDEV(MAJOR(first_dev), MINOR(first_dev) + i), NULL, DEV_NODE_NAME, i);
+        }
+        if (IS_ERR(dev_ret)) {
+            ret = PTR_ERR(dev_ret);
+            goto err_device;
+        }
+    }
+    /* Initializes cdev, remembering fops, making it ready to add to the system */
+    cdev_init(&char_dev, &led_fops);
+
+    /* Adds the device represented by char_dev to the system */
+    if ((ret = cdev_add(&char_dev, first_dev, NUM_MINORS)) < 0) {
+        i = NUM_MINORS;
+        goto err_device;
+    }
+
+    /* The buttons share the device class. A button gpio held by someone
+     * else, e.g. exported through sysfs, costs the buttons but not the LEDs */
+    if (btn_enable) {
+        if ((ret = btn_init()) < 0) {
+            printk(KERN_WARNING "Warning: buttons not available (%d), /dev/btnN not created\n", ret);
+        } else {
+            btn_active = true;
+        }
+    }
+    return 0;
+
+err_device:
+    while (--i >= 0) {
+        device_destroy(dev_class, MKDEV(MAJOR(first_dev), MINOR(first_dev) + i));
+    }
+    class_destroy(dev_class);
+err_region:
+    unregister_chrdev_region(first_dev, NUM_MINORS);
+err_stats:
+    debugfs_remove_recursive(led_debugfs);
+    free_page((unsigned long) led_status);
+    i = num_leds;
+err_gpio:
+    while (--i >= 0) {
+        gpio_free(leds[i]);
+    }
+    led_state_free();
+    return ret;
+}
+
+/****************************************************************************/
+/* Module cleanup (Destructor)						                        */
+/****************************************************************************/
+
+static void __exit led_exit(void)
+{
+    int i;
+
+    /* Release the buttons */
+    if (btn_active) {
+        btn_exit();
+    }
+
+    /* Stop a running pattern */
+    mutex_lock(&pattern_mutex);
+    led_pattern_stop();
+    mutex_unlock(&pattern_mutex);
+
+    /* Stop the software PWM */
+    hrtimer_cancel(&pwm_timer);
+
+    /* Stop the command queues */
+    for (i=0; i<NUM_MINORS; i++) {
+        hrtimer_cancel(&led_queues[i].timer);
+    }
+
+    /* Remove char_dev from the system */
+    cdev_del(&char_dev);
+
+    /* Unregisters and cleans up devices created with a call to device_create */
+    for (i=0; i<NUM_MINORS; i++) {
+        device_destroy(dev_class, MKDEV(MAJOR(first_dev), MINOR(first_dev) + i));
+    }
+
+    /* Destroy an existing class */
+    class_destroy(dev_class);
+
+    /* Unregister a range of device numbers */
+    unregister_chrdev_region(first_dev, NUM_MINORS);
+
+    /* Release previously requested gpios and the status page */
+    for (i=0; i<num_leds; i++) {
+        gpio_free(leds[i]);
+    }
+    free_page((unsigned long) led_status);
+
+    /* Remove the statistics and the per LED state */
+    debugfs_remove_recursive(led_debugfs);
+    led_state_free();
+
     /* Inform user */
     printk(KERN_INFO "\nInfo: led_driver_quad unregistered!\n\n");
 }
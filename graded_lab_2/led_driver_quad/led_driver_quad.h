@@ -0,0 +1,323 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Beagle Bone Black Driver Exercise -- userspace interface
+ *
+ * \file    led_driver_quad.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ *   Shared by the led_driver_quad module and its userspace tools.
+ *
+ *   LED masks: bit n stands for /dev/led<n>, a set bit means LED on.
+ *
+ *   The aggregate node /dev/leds gets or sets all LEDs in one syscall:
+ *   read()  returns the current mask as one __u64
+ *   write() of one __u64 sets all LEDs to that mask
+ *   write() of a struct led_batch_hdr followed by its entries applies a
+ *           whole batch of commands at once, see below
+ *   ioctl() with the LED_IOC_* requests below
+ *
+ *   A pattern (frames of LED masks with durations, played a number of
+ *   loops) can be uploaded with LED_IOC_PATTERN_START. The driver plays it
+ *   from a high resolution timer without waking userspace.
+ *
+ *   Every node has a queue of commands with absolute CLOCK_MONOTONIC
+ *   deadlines (LED_IOC_QUEUE_*). The driver executes them from a timer
+ *   and records the lateness of each one.
+ *
+ *   poll() on a node reports POLLIN once its LEDs changed since the last
+ *   read of this open file. After LED_IOC_EVENTS read() returns a struct
+ *   led_event per change instead of the normal format and blocks until
+ *   the next change (unless O_NONBLOCK).
+ *
+ *   LED_IOC_PWM_SET_DUTY dims an LED with a software PWM (duty in per
+ *   mille, 0 hands the LED back to on/off control). All PWM LEDs share
+ *   one timer and one frequency.
+ *
+ *   The buttons are /dev/btn0..3. read() returns struct btn_event
+ *   records of debounced press and release events, poll() reports POLLIN
+ *   while events are queued. With BTN_IOC_SET_REFLEX a button drives LEDs
+ *   directly from its interrupt, userspace only configures the mapping.
+ *
+ *   Every node can be mapped read-only with mmap(). The page holds a
+ *   struct led_status_page that the driver updates on every change, so
+ *   observers read the LED state without any syscall. Use
+ *   led_status_read() to get a consistent snapshot.
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   mmap-able status page
+ * \remark  V1.2, SCHMA5, 18.10.2026   Binary batch write protocol
+ * \remark  V1.3, SCHMA5, 18.10.2026   hrtimer pattern engine
+ * \remark  V1.4, SCHMA5, 18.10.2026   Deadline-stamped command queue
+ * \remark  V1.5, SCHMA5, 18.10.2026   poll() and change events
+ * \remark  V1.6, SCHMA5, 18.10.2026   Button event nodes
+ * \remark  V1.7, SCHMA5, 18.10.2026   In-kernel button to LED reflex
+ * \remark  V1.8, SCHMA5, 18.10.2026   Software PWM
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#ifndef LED_DRIVER_QUAD_H
+#define LED_DRIVER_QUAD_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/ioctl.h>
+#else
+#include <linux/types.h>
+#include <sys/ioctl.h>
+#endif
+
+/* Name of the aggregate device node */
+#define LED_AGGR_NODE_NAME	"leds"
+
+/* Names of the button nodes */
+#define BTN_NODE_NAME		"btn%d"
+
+/* Update the LEDs selected by mask to the bits in value */
+struct led_mask_update {
+    __u64 mask;
+    __u64 value;
+};
+
+/*
+ * Batch write to /dev/leds: one header, then count entries of the given
+ * type. The entries are folded in order into one update that is applied
+ * atomically, a batch with an invalid entry changes nothing (-EINVAL).
+ */
+#define LED_BATCH_MAGIC		0x4244454cU	/* "LEDB" little endian */
+#define LED_BATCH_MAX		256		/* Entries per batch */
+
+enum led_batch_type {
+    LED_BATCH_SET    = 1,	/* struct led_batch_set entries */
+    LED_BATCH_UPDATE = 2	/* struct led_mask_update entries */
+};
+
+struct led_batch_hdr {
+    __u32 magic;		/* LED_BATCH_MAGIC */
+    __u16 type;			/* enum led_batch_type */
+    __u16 count;		/* Number of entries, 1..LED_BATCH_MAX */
+};
+
+/* Set LED led (the minor of /dev/led<n>) on or off */
+struct led_batch_set {
+    __u8 led;
+    __u8 on;
+};
+
+/*
+ * Pattern upload. Frame n is shown duration_us after frame n-1, the
+ * deadlines are absolute so errors do not add up. After the last loop the
+ * LEDs keep the last frame. loops = 0 plays the pattern until stopped.
+ */
+#define LED_PATTERN_MAX_FRAMES	1024
+#define LED_PATTERN_MIN_US	50
+
+struct led_frame {
+    __u64 mask;			/* LED state of the frame, bit set = on */
+    __u32 duration_us;		/* Time until the next frame */
+    __u32 reserved;
+};
+
+struct led_pattern {
+    __u32 count;		/* Number of frames, 1..LED_PATTERN_MAX_FRAMES */
+    __u32 loops;		/* Loops to play, 0 = forever */
+    __u64 frames;		/* User pointer to count struct led_frame */
+};
+
+/* Progress and timing error of the current or last pattern */
+struct led_pattern_status {
+    __u32 running;		/* 1 while the pattern plays */
+    __u32 frame;		/* Next frame to show */
+    __u32 loop;			/* Completed loops */
+    __u32 late_frames;		/* Frames shown after the next deadline */
+    __u64 frames_shown;		/* Frames shown since the start */
+    __s64 err_last_ns;		/* Timer lateness of the last frame */
+    __s64 err_max_ns;		/* Worst lateness */
+    __u64 err_sum_ns;		/* Sum of the lateness, for the mean */
+};
+
+/*
+ * Deadline-stamped command. The mask must be within the LEDs of the node
+ * (bit n on /dev/led<n>, any LED on /dev/leds). A deadline in the past
+ * executes at once and shows up as lateness.
+ */
+#define LED_QUEUE_DEPTH		64	/* Pending commands per node */
+#define LED_QUEUE_RESULTS	64	/* Kept results per node */
+
+struct led_timed_cmd {
+    __u64 deadline_ns;		/* Absolute CLOCK_MONOTONIC time */
+    __u64 mask;			/* LEDs to change */
+    __u64 value;		/* New state of the LEDs in mask */
+    __u32 id;			/* Returned in the result */
+    __u32 reserved;
+};
+
+/* Outcome of one executed command */
+struct led_queue_result {
+    __u32 id;
+    __u32 reserved;
+    __u64 deadline_ns;		/* Requested time */
+    __u64 done_ns;		/* Time the LEDs were set */
+    __s64 late_ns;		/* done_ns - deadline_ns */
+};
+
+struct led_queue_stats {
+    __u32 pending;		/* Commands waiting for their deadline */
+    __u32 results;		/* Results not yet fetched */
+    __u64 executed;		/* Commands executed */
+    __u64 lost_results;		/* Results overwritten before fetched */
+    __s64 late_max_ns;		/* Worst lateness */
+    __s64 late_sum_ns;		/* Sum of the lateness, for the mean */
+};
+
+/*
+ * Change event, returned by read() in event mode. seq counts the changes
+ * of the node, a gap means that changes happened between two reads.
+ */
+struct led_event {
+    __u32 seq;			/* Change count of the node */
+    __u32 reserved;
+    __u64 mask;			/* LED state after the change, bit set = on */
+    __u64 changed_ns;		/* CLOCK_MONOTONIC time of the change */
+};
+
+/*
+ * Debounced button event. ts_ns is the time of the interrupt that
+ * detected the edge, for an edge found after the debounce time it is the
+ * time of that check.
+ */
+struct btn_event {
+    __u64 ts_ns;		/* CLOCK_MONOTONIC time of the edge */
+    __u32 button;		/* Button number, n of /dev/btn<n> */
+    __u32 pressed;		/* 1 = pressed, 0 = released */
+};
+
+/* State of a button node */
+struct btn_state {
+    __u32 pressed;		/* Debounced state, 1 = pressed */
+    __u32 queued;		/* Events waiting to be read */
+    __u32 lost;			/* Events dropped because the queue was full */
+    __u32 debounce_ms;		/* Debounce time in use */
+};
+
+/*
+ * Software PWM. Every period starts with all PWM LEDs on, each LED goes
+ * off after duty/LED_PWM_DUTY_MAX of the period. late_* is the timer
+ * lateness of the edges (jitter), cpu_* the time spent in the timer.
+ */
+#define LED_PWM_DUTY_MAX	1000
+#define LED_PWM_FREQ_MIN	10
+#define LED_PWM_FREQ_MAX	5000
+#define LED_PWM_FREQ_DEF	200
+
+struct led_pwm_stats {
+    __u32 freq_hz;		/* PWM frequency */
+    __u32 channels;		/* LEDs under PWM */
+    __u64 elapsed_ns;		/* Time since the PWM started */
+    __u64 periods;		/* PWM periods */
+    __u64 edges;		/* Timer runs, one per distinct edge */
+    __u64 cpu_ns;		/* Time spent in the timer */
+    __u64 cpu_max_ns;		/* Longest timer run */
+    __s64 late_max_ns;		/* Worst edge lateness */
+    __u64 late_sum_ns;		/* Sum of the edge lateness, for the mean */
+};
+
+/*
+ * Button to LED reflex, applied in the interrupt of the button
+ */
+enum btn_reflex_mode {
+    BTN_REFLEX_OFF      = 0,	/* No mapping */
+    BTN_REFLEX_DIRECT   = 1,	/* LEDs on while pressed */
+    BTN_REFLEX_INVERTED = 2,	/* LEDs on while released */
+    BTN_REFLEX_TOGGLE   = 3	/* LEDs toggle on every press */
+};
+
+struct btn_reflex {
+    __u32 mode;			/* enum btn_reflex_mode */
+    __u32 reserved;
+    __u64 leds;			/* LED mask driven by the button */
+};
+
+/*
+ * Latency from the button interrupt to the LED write. hist[k] counts the
+ * latencies in [2^k, 2^(k+1)) ns, the last bucket everything above.
+ */
+#define BTN_REFLEX_HIST		24
+
+struct btn_reflex_stats {
+    __u64 count;		/* Reflexes applied */
+    __u64 sum_ns;		/* Sum of the latencies, for the mean */
+    __u64 max_ns;		/* Worst latency */
+    __u32 hist[BTN_REFLEX_HIST];
+};
+
+/*
+ * Read-only status page. seq is odd while the driver updates the page,
+ * a snapshot is consistent if seq was even and unchanged around it.
+ */
+struct led_status_page {
+    __u32 seq;			/* Update sequence count */
+    __u32 count;		/* Number of LEDs */
+    __u64 mask;			/* LED state, bit set = on */
+    __u64 changed_ns;		/* CLOCK_MONOTONIC time of the last change */
+    __u64 changes;		/* Number of state changes */
+};
+
+#ifndef __KERNEL__
+/* Consistent snapshot of the status page, no syscall involved */
+static inline void led_status_read(const volatile struct led_status_page *page,
+                                   struct led_status_page *snap)
+{
+    __u32 seq;
+
+    do {
+        while ((seq = page->seq) & 1) {
+            ;
+        }
+        __sync_synchronize();
+        snap->count      = page->count;
+        snap->mask       = page->mask;
+        snap->changed_ns = page->changed_ns;
+        snap->changes    = page->changes;
+        __sync_synchronize();
+    } while (page->seq != seq);
+    snap->seq = seq;
+}
+#endif
+
+/* ioctl requests, valid on every node of the driver */
+#define LED_IOC_MAGIC		'L'
+#define LED_IOC_GET_MASK	_IOR(LED_IOC_MAGIC, 0, __u64)
+#define LED_IOC_SET_MASK	_IOW(LED_IOC_MAGIC, 1, __u64)
+#define LED_IOC_UPDATE		_IOW(LED_IOC_MAGIC, 2, struct led_mask_update)
+#define LED_IOC_GET_COUNT	_IOR(LED_IOC_MAGIC, 3, __u32)
+#define LED_IOC_PATTERN_START	_IOW(LED_IOC_MAGIC, 4, struct led_pattern)
+#define LED_IOC_PATTERN_STOP	_IO(LED_IOC_MAGIC, 5)
+#define LED_IOC_PATTERN_STATUS	_IOR(LED_IOC_MAGIC, 6, struct led_pattern_status)
+#define LED_IOC_QUEUE_ADD	_IOW(LED_IOC_MAGIC, 7, struct led_timed_cmd)
+#define LED_IOC_QUEUE_FLUSH	_IO(LED_IOC_MAGIC, 8)
+#define LED_IOC_QUEUE_RESULT	_IOR(LED_IOC_MAGIC, 9, struct led_queue_result)
+#define LED_IOC_QUEUE_STATS	_IOR(LED_IOC_MAGIC, 10, struct led_queue_stats)
+#define LED_IOC_EVENTS		_IOW(LED_IOC_MAGIC, 11, __u32)
+#define LED_IOC_PWM_SET_DUTY	_IOW(LED_IOC_MAGIC, 12, __u32)
+#define LED_IOC_PWM_SET_FREQ	_IOW(LED_IOC_MAGIC, 13, __u32)
+#define LED_IOC_PWM_STATS	_IOR(LED_IOC_MAGIC, 14, struct led_pwm_stats)
+
+/* ioctl requests of the button nodes */
+#define BTN_IOC_GET_STATE	_IOR(LED_IOC_MAGIC, 32, struct btn_state)
+#define BTN_IOC_SET_REFLEX	_IOW(LED_IOC_MAGIC, 33, struct btn_reflex)
+#define BTN_IOC_GET_REFLEX	_IOR(LED_IOC_MAGIC, 34, struct btn_reflex)
+#define BTN_IOC_REFLEX_STATS	_IOR(LED_IOC_MAGIC, 35, struct btn_reflex_stats)
+
+#endif /* LED_DRIVER_QUAD_H */
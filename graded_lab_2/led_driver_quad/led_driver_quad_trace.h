@@ -0,0 +1,113 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Beagle Bone Black Driver Exercise -- tracepoints
+ *
+ * \file    led_driver_quad_trace.h
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ *   Tracepoints of led_driver_quad, they cost a not taken branch while
+ *   disabled. Enable them with:
+ *   echo 1 > /sys/kernel/debug/tracing/events/led_driver_quad/enable
+ *   cat /sys/kernel/debug/tracing/trace_pipe
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM led_driver_quad
+
+#if !defined(LED_DRIVER_QUAD_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define LED_DRIVER_QUAD_TRACE_H
+
+#include <linux/tracepoint.h>
+
+/* Open and close of a node */
+DECLARE_EVENT_CLASS(led_file,
+    TP_PROTO(int minor),
+    TP_ARGS(minor),
+    TP_STRUCT__entry(
+        __field(int, minor)
+    ),
+    TP_fast_assign(
+        __entry->minor = minor;
+    ),
+    TP_printk("minor=%d", __entry->minor)
+);
+
+DEFINE_EVENT(led_file, led_open,
+    TP_PROTO(int minor),
+    TP_ARGS(minor)
+);
+
+DEFINE_EVENT(led_file, led_close,
+    TP_PROTO(int minor),
+    TP_ARGS(minor)
+);
+
+/* read() and write(), ret is the byte count or the negative error */
+DECLARE_EVENT_CLASS(led_io,
+    TP_PROTO(int minor, size_t count, ssize_t ret),
+    TP_ARGS(minor, count, ret),
+    TP_STRUCT__entry(
+        __field(int, minor)
+        __field(size_t, count)
+        __field(ssize_t, ret)
+    ),
+    TP_fast_assign(
+        __entry->minor = minor;
+        __entry->count = count;
+        __entry->ret   = ret;
+    ),
+    TP_printk("minor=%d count=%zu ret=%zd", __entry->minor, __entry->count, __entry->ret)
+);
+
+DEFINE_EVENT(led_io, led_read,
+    TP_PROTO(int minor, size_t count, ssize_t ret),
+    TP_ARGS(minor, count, ret)
+);
+
+DEFINE_EVENT(led_io, led_write,
+    TP_PROTO(int minor, size_t count, ssize_t ret),
+    TP_ARGS(minor, count, ret)
+);
+
+/* LED state change, from any source (write, ioctl, timers, buttons) */
+TRACE_EVENT(led_update,
+    TP_PROTO(u64 mask, u64 state, u64 changed),
+    TP_ARGS(mask, state, changed),
+    TP_STRUCT__entry(
+        __field(u64, mask)
+        __field(u64, state)
+        __field(u64, changed)
+    ),
+    TP_fast_assign(
+        __entry->mask    = mask;
+        __entry->state   = state;
+        __entry->changed = changed;
+    ),
+    TP_printk("mask=0x%llx state=0x%llx changed=0x%llx",
+              (unsigned long long) __entry->mask, (unsigned long long) __entry->state,
+              (unsigned long long) __entry->changed)
+);
+
+#endif /* LED_DRIVER_QUAD_TRACE_H */
+
+/* This part must be outside the include guard */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE led_driver_quad_trace
+#include <trace/define_trace.h>
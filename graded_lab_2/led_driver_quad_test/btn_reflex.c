@@ -0,0 +1,175 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Configure the in-kernel button to LED reflex of led_driver_quad
+ *
+ *          Without options every button Tn drives LED Ln directly, the
+ *          same mapping as ex_button_led_mapping but done in the button
+ *          interrupt. The program then only prints the latency from the
+ *          interrupt to the LED write once per second, the mapping keeps
+ *          working after it exits.
+ *
+ *          Usage: btn_reflex [-m off|direct|inverted|toggle] [-b button
+ *                            -l ledmask] [-s] [-d devdir]
+ *                 -b/-l  map only this button (0..3) to the LED mask
+ *                 -s     only print the statistics, change nothing
+ *
+ * \file    btn_reflex.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define NUM_BUTTONS		4
+#define MAX_PATH_STR		256
+
+static volatile sig_atomic_t running = 1;
+
+static const char *mode_name[] = { "off", "direct", "inverted", "toggle" };
+
+/*
+ ***************************************************************************
+ * Stop on CTRL-C
+ ***************************************************************************
+ */
+static void signal_callback_handler(int signum)
+{
+    (void) signum;
+    running = 0;
+}
+
+/*
+ ***************************************************************************
+ * Print mapping and latency statistics of one button
+ ***************************************************************************
+ */
+static void print_stats(int button, int fd)
+{
+    struct btn_reflex reflex;
+    struct btn_reflex_stats st;
+    int k;
+
+    if (ioctl(fd, BTN_IOC_GET_REFLEX, &reflex) < 0 || ioctl(fd, BTN_IOC_REFLEX_STATS, &st) < 0) {
+        perror("BTN_IOC_REFLEX_STATS");
+        return;
+    }
+    printf("T%d %-8s leds 0x%02llx: %llu reflexes", button + 1,
+           reflex.mode <= BTN_REFLEX_TOGGLE ? mode_name[reflex.mode] : "?",
+           (unsigned long long) reflex.leds, (unsigned long long) st.count);
+    if (st.count) {
+        printf(", mean %llu ns, max %llu ns, log2 histogram:",
+               (unsigned long long) (st.sum_ns / st.count), (unsigned long long) st.max_ns);
+        for (k = 0; k < BTN_REFLEX_HIST; k++) {
+            if (st.hist[k]) {
+                printf(" %uns:%u", 1u << k, st.hist[k]);
+            }
+        }
+    }
+    printf("\n");
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    const char *dev_dir = "/dev";
+    struct btn_reflex reflex;
+    int fd[NUM_BUTTONS];
+    int mode = BTN_REFLEX_DIRECT, button = -1, stats_only = 0, i, opt;
+    uint64_t leds = 0;
+
+    while ((opt = getopt(argc, argv, "m:b:l:sd:")) != -1) {
+        switch (opt) {
+        case 'm':
+            for (mode = BTN_REFLEX_TOGGLE; mode > 0 && strcmp(optarg, mode_name[mode]) != 0; mode--) {
+                ;
+            }
+            break;
+        case 'b':
+            button = atoi(optarg);
+            break;
+        case 'l':
+            leds = strtoull(optarg, NULL, 0);
+            break;
+        case 's':
+            stats_only = 1;
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m off|direct|inverted|toggle] [-b button -l ledmask] "
+                    "[-s] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (button >= NUM_BUTTONS) {
+        fprintf(stderr, "button must be 0..%d\n", NUM_BUTTONS - 1);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < NUM_BUTTONS; i++) {
+        snprintf(path, sizeof(path), "%s/" BTN_NODE_NAME, dev_dir, i);
+        if ((fd[i] = open(path, O_RDONLY)) < 0) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        if (stats_only || (button >= 0 && button != i)) {
+            continue;
+        }
+
+        /* Tn drives Ln unless a mask was given */
+        reflex.mode     = mode;
+        reflex.reserved = 0;
+        reflex.leds     = (button >= 0) ? leds : (1ULL << i);
+        if (ioctl(fd[i], BTN_IOC_SET_REFLEX, &reflex) < 0) {
+            perror("BTN_IOC_SET_REFLEX");
+            return EXIT_FAILURE;
+        }
+    }
+
+    signal(SIGINT, signal_callback_handler);
+    do {
+        for (i = 0; i < NUM_BUTTONS; i++) {
+            print_stats(i, fd[i]);
+        }
+        if (stats_only) {
+            break;
+        }
+        sleep(1);
+    } while (running);
+
+    for (i = 0; i < NUM_BUTTONS; i++) {
+        close(fd[i]);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,148 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Print the debounced button events of led_driver_quad
+ *
+ *          Sleeps in poll() on /dev/btn0..3 and prints every press and
+ *          release with its kernel timestamp and the delay until this
+ *          program got it. No sysfs polling is involved.
+ *
+ *          Usage: btn_watch [-d devdir]
+ *
+ * \file    btn_watch.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define NUM_BUTTONS		4
+#define MAX_EVENTS		16
+#define MAX_PATH_STR		256
+
+static volatile sig_atomic_t running = 1;
+
+/*
+ ***************************************************************************
+ * Stop on CTRL-C
+ ***************************************************************************
+ */
+static void signal_callback_handler(int signum)
+{
+    (void) signum;
+    running = 0;
+}
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns, same clock as the event timestamps
+ ***************************************************************************
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    const char *dev_dir = "/dev";
+    struct pollfd pfd[NUM_BUTTONS];
+    struct btn_event ev[MAX_EVENTS];
+    struct btn_state st;
+    uint64_t now;
+    ssize_t len;
+    int i, j, n, opt;
+
+    while ((opt = getopt(argc, argv, "d:")) != -1) {
+        switch (opt) {
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (i = 0; i < NUM_BUTTONS; i++) {
+        snprintf(path, sizeof(path), "%s/" BTN_NODE_NAME, dev_dir, i);
+        if ((pfd[i].fd = open(path, O_RDONLY | O_NONBLOCK)) < 0) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+        pfd[i].events = POLLIN;
+    }
+
+    signal(SIGINT, signal_callback_handler);
+    while (running) {
+        if (poll(pfd, NUM_BUTTONS, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            break;
+        }
+        for (i = 0; i < NUM_BUTTONS; i++) {
+            if (!(pfd[i].revents & POLLIN)) {
+                continue;
+            }
+            if ((len = read(pfd[i].fd, ev, sizeof(ev))) < 0) {
+                continue;
+            }
+            now = now_ns();
+            n = len / sizeof(ev[0]);
+            for (j = 0; j < n; j++) {
+                printf("T%u %-8s at %llu.%09llu, delivered after %llu us\n",
+                       ev[j].button + 1, ev[j].pressed ? "pressed" : "released",
+                       (unsigned long long) (ev[j].ts_ns / 1000000000ULL),
+                       (unsigned long long) (ev[j].ts_ns % 1000000000ULL),
+                       (unsigned long long) ((now - ev[j].ts_ns) / 1000));
+            }
+            fflush(stdout);
+        }
+    }
+
+    /* Report lost events */
+    for (i = 0; i < NUM_BUTTONS; i++) {
+        if (ioctl(pfd[i].fd, BTN_IOC_GET_STATE, &st) == 0 && st.lost) {
+            printf("T%d: %u events lost\n", i + 1, st.lost);
+        }
+        close(pfd[i].fd);
+    }
+    return EXIT_SUCCESS;
+}
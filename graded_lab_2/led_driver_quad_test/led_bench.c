@@ -0,0 +1,253 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Benchmark of full LED pattern updates through led_driver_quad
+ *
+ *          Every update sets all LEDs to the next step of a moving light
+ *          pattern. The update is done in five ways:
+ *
+ *          ascii-open  open/write "on"|"off"/close per /dev/ledN
+ *          ascii       one write per /dev/ledN, nodes kept open
+ *          write       one binary __u64 write to /dev/leds
+ *          ioctl       one LED_IOC_SET_MASK ioctl on /dev/leds
+ *          batch       one LED_BATCH_SET batch with an entry per LED
+ *
+ *          For each way the syscalls and the time per full-pattern update
+ *          are printed.
+ *
+ *          Usage: led_bench [-n updates] [-d devdir]
+ *
+ * \file    led_bench.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Added the batch write method
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define DEF_UPDATES		10000
+#define MAX_LEDS		64
+#define MAX_PATH_STR		256
+
+/* Benchmark state */
+static const char *dev_dir = "/dev";
+static int         led_fd[MAX_LEDS];
+static int         aggr_fd = -1;
+static unsigned    num_leds;
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns
+ ***************************************************************************
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Moving light pattern, step n
+ ***************************************************************************
+ */
+static uint64_t pattern(uint64_t n)
+{
+    return 1ULL << (n % num_leds);
+}
+
+/*
+ ***************************************************************************
+ * Path of /dev/ledN
+ ***************************************************************************
+ */
+static void led_path(char *buf, size_t size, unsigned i)
+{
+    snprintf(buf, size, "%s/led%u", dev_dir, i);
+}
+
+/*
+ ***************************************************************************
+ * The update methods, each returns the number of syscalls used or
+ * -1 on errors
+ ***************************************************************************
+ */
+static int update_ascii_open(uint64_t mask)
+{
+    char path[MAX_PATH_STR];
+    const char *cmd;
+    unsigned i;
+    int fd;
+
+    for (i = 0; i < num_leds; i++) {
+        led_path(path, sizeof(path), i);
+        cmd = (mask & (1ULL << i)) ? "on" : "off";
+        if ((fd = open(path, O_WRONLY)) < 0) {
+            return -1;
+        }
+        if (write(fd, cmd, strlen(cmd)) < 0) {
+            close(fd);
+            return -1;
+        }
+        close(fd);
+    }
+    return 3 * num_leds;
+}
+
+static int update_ascii(uint64_t mask)
+{
+    const char *cmd;
+    unsigned i;
+
+    for (i = 0; i < num_leds; i++) {
+        cmd = (mask & (1ULL << i)) ? "on" : "off";
+        if (write(led_fd[i], cmd, strlen(cmd)) < 0) {
+            return -1;
+        }
+    }
+    return num_leds;
+}
+
+static int update_write(uint64_t mask)
+{
+    return write(aggr_fd, &mask, sizeof(mask)) == sizeof(mask) ? 1 : -1;
+}
+
+static int update_ioctl(uint64_t mask)
+{
+    return ioctl(aggr_fd, LED_IOC_SET_MASK, &mask) == 0 ? 1 : -1;
+}
+
+static int update_batch(uint64_t mask)
+{
+    struct {
+        struct led_batch_hdr hdr;
+        struct led_batch_set set[MAX_LEDS];
+    } batch;
+    size_t size;
+    unsigned i;
+
+    batch.hdr.magic = LED_BATCH_MAGIC;
+    batch.hdr.type  = LED_BATCH_SET;
+    batch.hdr.count = num_leds;
+    for (i = 0; i < num_leds; i++) {
+        batch.set[i].led = i;
+        batch.set[i].on  = (mask >> i) & 1;
+    }
+    size = sizeof(batch.hdr) + num_leds * sizeof(batch.set[0]);
+    return write(aggr_fd, &batch, size) == (ssize_t) size ? 1 : -1;
+}
+
+/*
+ ***************************************************************************
+ * Run one method and print the result
+ ***************************************************************************
+ */
+static void run(const char *name, int (*update)(uint64_t), unsigned updates)
+{
+    uint64_t t0, t1, syscalls = 0;
+    unsigned n;
+    int ret;
+
+    t0 = now_ns();
+    for (n = 0; n < updates; n++) {
+        if ((ret = update(pattern(n))) < 0) {
+            printf("%-10s: failed after %u updates\n", name, n);
+            return;
+        }
+        syscalls += ret;
+    }
+    t1 = now_ns();
+
+    printf("%-10s: %u updates, %5.1f syscalls/update, %9.0f ns/update\n",
+           name, updates, (double) syscalls / updates,
+           (double) (t1 - t0) / updates);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    unsigned updates = DEF_UPDATES, count = 0, i;
+    uint64_t off = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:d:")) != -1) {
+        switch (opt) {
+        case 'n':
+            updates = atoi(optarg);
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n updates] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* The aggregate node tells how many LEDs there are */
+    snprintf(path, sizeof(path), "%s/%s", dev_dir, LED_AGGR_NODE_NAME);
+    if ((aggr_fd = open(path, O_RDWR)) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    if (ioctl(aggr_fd, LED_IOC_GET_COUNT, &count) < 0 || count == 0 || count > MAX_LEDS) {
+        perror("LED_IOC_GET_COUNT");
+        return EXIT_FAILURE;
+    }
+    num_leds = count;
+
+    for (i = 0; i < num_leds; i++) {
+        led_path(path, sizeof(path), i);
+        if ((led_fd[i] = open(path, O_WRONLY)) < 0) {
+            perror(path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%u LEDs, %u full-pattern updates per method\n", num_leds, updates);
+    run("ascii-open", update_ascii_open, updates);
+    run("ascii", update_ascii, updates);
+    run("write", update_write, updates);
+    run("ioctl", update_ioctl, updates);
+    run("batch", update_batch, updates);
+
+    /* All LEDs off */
+    ioctl(aggr_fd, LED_IOC_SET_MASK, &off);
+    for (i = 0; i < num_leds; i++) {
+        close(led_fd[i]);
+    }
+    close(aggr_fd);
+    return EXIT_SUCCESS;
+}
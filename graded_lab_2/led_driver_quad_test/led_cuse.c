@@ -0,0 +1,200 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          CUSE stand-in for the /dev/ledN nodes of led_driver_quad
+ *
+ *          Creates /dev/led0..N-1 in userspace with CUSE and speaks the
+ *          same ASCII protocol as the driver:
+ *
+ *          write "on"/"off"  sets the LED, other text is ignored, more
+ *                            than 32 bytes fail with EINVAL
+ *          read              returns "\non\n" or "\noff\n"
+ *
+ *          CUSE serves one node per session, so one child process is
+ *          forked per LED. This lets led_load run on any Linux host with
+ *          /dev/cuse (root required). Ctrl-C removes the nodes.
+ *
+ *          Usage: led_cuse [-n leds] [-v]
+ *
+ * \file    led_cuse.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#define FUSE_USE_VERSION 29
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <cuse_lowlevel.h>
+
+/* Define some useful constants, same as the driver */
+#define DEF_LEDS		4
+#define MAX_LEDS		64
+#define MAX_MSG_SIZE		32
+#define MAX_NAME_STR		32
+
+/* State of the LED served by this process */
+static volatile int led_on;
+static int          verbose;
+
+static pid_t child[MAX_LEDS];
+static unsigned num_leds = DEF_LEDS;
+
+/*
+ ***************************************************************************
+ * CUSE callbacks
+ ***************************************************************************
+ */
+static void led_cuse_open(fuse_req_t req, struct fuse_file_info *fi)
+{
+    fuse_reply_open(req, fi);
+}
+
+static void led_cuse_read(fuse_req_t req, size_t size, off_t off, struct fuse_file_info *fi)
+{
+    const char *onOff = led_on ? "\non\n" : "\noff\n";
+    size_t len = strlen(onOff);
+
+    if (off >= (off_t) len) {
+        fuse_reply_buf(req, NULL, 0);
+        return;
+    }
+    if (off + size > len) {
+        size = len - off;
+    }
+    fuse_reply_buf(req, onOff + off, size);
+}
+
+static void led_cuse_write(fuse_req_t req, const char *buf, size_t size, off_t off,
+                           struct fuse_file_info *fi)
+{
+    if (size > MAX_MSG_SIZE) {
+        fuse_reply_err(req, EINVAL);
+        return;
+    }
+    if (size >= 2 && strncmp(buf, "on", 2) == 0) {
+        led_on = 1;
+    } else if (size >= 3 && strncmp(buf, "off", 3) == 0) {
+        led_on = 0;
+    }
+    fuse_reply_write(req, size);
+}
+
+static const struct cuse_lowlevel_ops led_cuse_ops = {
+    .open  = led_cuse_open,
+    .read  = led_cuse_read,
+    .write = led_cuse_write,
+};
+
+/*
+ ***************************************************************************
+ * Serve /dev/ledN in the calling process, returns when the session ends
+ ***************************************************************************
+ */
+static int led_cuse_serve(unsigned n, const char *prog)
+{
+    char dev_name[MAX_NAME_STR];
+    const char *dev_info[] = { dev_name };
+    char *args[] = { (char *) prog, "-f", "-s", NULL, NULL };
+    struct cuse_info ci;
+    int argc = 3;
+
+    snprintf(dev_name, sizeof(dev_name), "DEVNAME=led%u", n);
+    if (verbose) {
+        args[argc++] = "-d";
+    }
+
+    memset(&ci, 0, sizeof(ci));
+    ci.dev_info_argc = 1;
+    ci.dev_info_argv = dev_info;
+
+    return cuse_lowlevel_main(argc, args, &ci, &led_cuse_ops, NULL);
+}
+
+/*
+ ***************************************************************************
+ * Stop all children on Ctrl-C
+ ***************************************************************************
+ */
+static void signal_callback_handler(int signum)
+{
+    unsigned i;
+
+    for (i = 0; i < num_leds; i++) {
+        if (child[i] > 0) {
+            kill(child[i], SIGTERM);
+        }
+    }
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    unsigned i;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:v")) != -1) {
+        switch (opt) {
+        case 'n':
+            num_leds = atoi(optarg);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n leds] [-v]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (num_leds == 0 || num_leds > MAX_LEDS) {
+        fprintf(stderr, "1..%d LEDs\n", MAX_LEDS);
+        return EXIT_FAILURE;
+    }
+
+    /* One CUSE session per node */
+    for (i = 0; i < num_leds; i++) {
+        if ((child[i] = fork()) < 0) {
+            perror("fork");
+            signal_callback_handler(SIGTERM);
+            return EXIT_FAILURE;
+        }
+        if (child[i] == 0) {
+            signal(SIGINT, SIG_IGN);
+            exit(led_cuse_serve(i, argv[0]) == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    signal(SIGINT, signal_callback_handler);
+    signal(SIGTERM, signal_callback_handler);
+    printf("Serving /dev/led0..%u, Ctrl-C to stop\n", num_leds - 1);
+
+    /* Wait for all sessions to end */
+    while (wait(NULL) > 0 || errno == EINTR) {
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,463 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Multi-threaded load and contention generator for /dev/ledN
+ *
+ *          Every worker opens /dev/led0..N-1 once and writes the ASCII
+ *          commands "on"/"off" as fast as it can, following one of the
+ *          patterns:
+ *
+ *          walk    moving light, thread t starts at LED t
+ *          toggle  every write flips one LED, LEDs in turn
+ *          random  random LED, random state
+ *          same    all workers flip LED 0, every write is a change
+ *          hold    all workers write "on" to LED 0, no write is a change
+ *
+ *          same and hold measure the contention on one LED. With -P the
+ *          workers are processes instead of threads, each with its own
+ *          open files, so the driver sees independent writers.
+ *
+ *          With -r every write is followed by a read back of the node.
+ *          Each operation is timed; at the end the writes per second, the
+ *          latency percentiles and a log2 histogram per operation are
+ *          printed.
+ *
+ *          The scaling of the lock-free single LED writes of the driver
+ *          shows with one run per worker count:
+ *
+ *          for t in 1 2 4 8; do led_load -P -p walk -t $t -s 5; done
+ *
+ *          walk keeps the workers on different LEDs, so the writes per
+ *          second should grow with the workers up to the CPU count, while
+ *          same stays flat.
+ *
+ *          Only the ASCII protocol of the single LED nodes is used, so the
+ *          same run works against led_driver_quad and against the CUSE
+ *          stand-in led_cuse on a host without the hardware.
+ *
+ *          Usage: led_load [-t workers] [-s seconds] [-P]
+ *                          [-p walk|toggle|random|same|hold]
+ *                          [-n leds] [-r] [-d devdir]
+ *
+ * \file    led_load.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Contention patterns, worker processes
+ * \remark  V1.2, SCHMA5, 18.10.2026   Scaling run of the single LED writes
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/* Define some useful constants */
+#define DEF_THREADS		4
+#define DEF_SECONDS		5
+#define MAX_THREADS		64
+#define MAX_LEDS		64
+#define MAX_PATH_STR		256
+#define HIST_BUCKETS		32	/* [2^k, 2^(k+1)) ns */
+
+/* Patterns */
+enum pattern { PAT_WALK, PAT_TOGGLE, PAT_RANDOM, PAT_SAME, PAT_HOLD };
+
+static const char *pat_name[] = { "walk", "toggle", "random", "same", "hold" };
+
+/* Timed operations */
+enum op { OP_WRITE, OP_READ, OP_COUNT };
+
+static const char *op_name[OP_COUNT] = { "write", "read" };
+
+/* Latency histogram of one operation */
+struct hist {
+    uint64_t count;
+    uint64_t errors;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t bucket[HIST_BUCKETS];
+};
+
+/* Per worker state, the histograms are merged after the run. Shared with
+ * the worker processes in -P mode. */
+struct worker {
+    pthread_t    thread;
+    pid_t        pid;
+    unsigned     index;
+    int          fd[MAX_LEDS];
+    unsigned int seed;
+    struct hist  hist[OP_COUNT];
+};
+
+/* Run configuration */
+static const char   *dev_dir   = "/dev";
+static unsigned      num_leds;
+static enum pattern  pat       = PAT_WALK;
+static int           read_back;
+static int           use_procs;
+
+/* Workers and the run flag, in shared memory for worker processes */
+static struct shared {
+    volatile int  running;
+    struct worker workers[MAX_THREADS];
+} *sh;
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns
+ ***************************************************************************
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Path of /dev/ledN
+ ***************************************************************************
+ */
+static void led_path(char *buf, size_t size, unsigned i)
+{
+    snprintf(buf, size, "%s/led%u", dev_dir, i);
+}
+
+/*
+ ***************************************************************************
+ * Add one sample to a histogram
+ ***************************************************************************
+ */
+static void hist_add(struct hist *h, uint64_t ns, int failed)
+{
+    int k = ns ? 63 - __builtin_clzll(ns) : 0;
+
+    if (failed) {
+        h->errors++;
+        return;
+    }
+    h->count++;
+    h->sum_ns += ns;
+    if (ns > h->max_ns) {
+        h->max_ns = ns;
+    }
+    h->bucket[k < HIST_BUCKETS ? k : HIST_BUCKETS - 1]++;
+}
+
+static void hist_merge(struct hist *dst, const struct hist *src)
+{
+    int k;
+
+    dst->count  += src->count;
+    dst->errors += src->errors;
+    dst->sum_ns += src->sum_ns;
+    if (src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+    for (k = 0; k < HIST_BUCKETS; k++) {
+        dst->bucket[k] += src->bucket[k];
+    }
+}
+
+/*
+ ***************************************************************************
+ * Upper bound of the bucket holding the given percentile
+ ***************************************************************************
+ */
+static uint64_t hist_percentile(const struct hist *h, double pct)
+{
+    uint64_t want = (uint64_t) (h->count * pct / 100.0), seen = 0;
+    int k;
+
+    for (k = 0; k < HIST_BUCKETS; k++) {
+        seen += h->bucket[k];
+        if (seen > want) {
+            return 2ULL << k;
+        }
+    }
+    return h->max_ns;
+}
+
+static void hist_print(const char *name, const struct hist *h, double seconds)
+{
+    uint64_t peak = 0;
+    int k, lo = -1, hi = 0, bar;
+
+    printf("%-5s: %llu ops, %.0f ops/s, %llu errors\n", name,
+           (unsigned long long) h->count, h->count / seconds,
+           (unsigned long long) h->errors);
+    if (h->count == 0) {
+        return;
+    }
+    printf("       mean %llu ns, p50 < %llu ns, p99 < %llu ns, max %llu ns\n",
+           (unsigned long long) (h->sum_ns / h->count),
+           (unsigned long long) hist_percentile(h, 50.0),
+           (unsigned long long) hist_percentile(h, 99.0),
+           (unsigned long long) h->max_ns);
+
+    for (k = 0; k < HIST_BUCKETS; k++) {
+        if (h->bucket[k]) {
+            if (lo < 0) {
+                lo = k;
+            }
+            hi = k;
+            if (h->bucket[k] > peak) {
+                peak = h->bucket[k];
+            }
+        }
+    }
+    for (k = lo; k <= hi; k++) {
+        bar = (int) (h->bucket[k] * 40 / peak);
+        printf("       %10llu ns %10llu |%.*s\n", 1ULL << k,
+               (unsigned long long) h->bucket[k], bar,
+               "****************************************");
+    }
+}
+
+/*
+ ***************************************************************************
+ * Next LED and state of a worker, step n
+ ***************************************************************************
+ */
+static void next_cmd(struct worker *w, uint64_t n, unsigned *led, int *on)
+{
+    switch (pat) {
+    case PAT_WALK:
+        /* One LED on, the previous one off, in alternating steps */
+        *led = (w->index + n / 2) % num_leds;
+        *on  = !(n & 1);
+        break;
+    case PAT_TOGGLE:
+        *led = (w->index + n) % num_leds;
+        *on  = (n / num_leds) & 1;
+        break;
+    case PAT_RANDOM:
+        *led = rand_r(&w->seed) % num_leds;
+        *on  = rand_r(&w->seed) & 1;
+        break;
+    case PAT_SAME:
+        *led = 0;
+        *on  = n & 1;
+        break;
+    default:
+        *led = 0;
+        *on  = 1;
+        break;
+    }
+}
+
+/*
+ ***************************************************************************
+ * Worker thread
+ ***************************************************************************
+ */
+static void *worker_main(void *arg)
+{
+    struct worker *w = arg;
+    char buf[16];
+    const char *cmd;
+    uint64_t n, t0, t1;
+    unsigned led;
+    ssize_t ret;
+    int on;
+
+    for (n = 0; sh->running; n++) {
+        next_cmd(w, n, &led, &on);
+        cmd = on ? "on" : "off";
+
+        t0  = now_ns();
+        ret = write(w->fd[led], cmd, strlen(cmd));
+        t1  = now_ns();
+        hist_add(&w->hist[OP_WRITE], t1 - t0, ret < 0);
+
+        if (read_back) {
+            t0  = now_ns();
+            ret = pread(w->fd[led], buf, sizeof(buf), 0);
+            t1  = now_ns();
+            hist_add(&w->hist[OP_READ], t1 - t0, ret < 0);
+        }
+    }
+    return NULL;
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    struct hist total[OP_COUNT];
+    unsigned threads = DEF_THREADS, seconds = DEF_SECONDS, t, i, p;
+    struct worker *workers;
+    uint64_t t0, t1;
+    double elapsed;
+    int opt, fd;
+
+    while ((opt = getopt(argc, argv, "t:s:Pp:n:rd:")) != -1) {
+        switch (opt) {
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 's':
+            seconds = atoi(optarg);
+            break;
+        case 'P':
+            use_procs = 1;
+            break;
+        case 'p':
+            for (p = 0; p < sizeof(pat_name) / sizeof(pat_name[0]); p++) {
+                if (strcmp(optarg, pat_name[p]) == 0) {
+                    break;
+                }
+            }
+            if (p == sizeof(pat_name) / sizeof(pat_name[0])) {
+                fprintf(stderr, "Unknown pattern %s\n", optarg);
+                return EXIT_FAILURE;
+            }
+            pat = p;
+            break;
+        case 'n':
+            num_leds = atoi(optarg);
+            break;
+        case 'r':
+            read_back = 1;
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-t workers] [-s seconds] [-P] "
+                    "[-p walk|toggle|random|same|hold] [-n leds] [-r] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (threads == 0 || threads > MAX_THREADS || num_leds > MAX_LEDS) {
+        fprintf(stderr, "1..%d workers and up to %d LEDs\n", MAX_THREADS, MAX_LEDS);
+        return EXIT_FAILURE;
+    }
+
+    /* Anonymous shared mapping, seen by threads and forked workers */
+    sh = mmap(NULL, sizeof(*sh), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (sh == MAP_FAILED) {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+    sh->running = 1;
+    workers = sh->workers;
+
+    /* Without -n count the nodes, the stand-in has no /dev/leds to ask */
+    if (num_leds == 0) {
+        for (i = 0; i < MAX_LEDS; i++) {
+            led_path(path, sizeof(path), i);
+            if (access(path, W_OK) != 0) {
+                break;
+            }
+        }
+        num_leds = i;
+    }
+    if (num_leds == 0) {
+        fprintf(stderr, "No LED nodes in %s\n", dev_dir);
+        return EXIT_FAILURE;
+    }
+
+    /* Every thread has its own file descriptors, opened once */
+    for (t = 0; t < threads; t++) {
+        workers[t].index = t;
+        workers[t].seed  = t + 1;
+        for (i = 0; i < num_leds; i++) {
+            led_path(path, sizeof(path), i);
+            if ((fd = open(path, read_back ? O_RDWR : O_WRONLY)) < 0) {
+                perror(path);
+                return EXIT_FAILURE;
+            }
+            workers[t].fd[i] = fd;
+        }
+    }
+
+    printf("%u LEDs, %u %s, %u s, pattern %s%s\n", num_leds, threads,
+           use_procs ? "processes" : "threads", seconds, pat_name[pat],
+           read_back ? ", read back" : "");
+
+    t0 = now_ns();
+    for (t = 0; t < threads; t++) {
+        if (use_procs) {
+            if ((workers[t].pid = fork()) == 0) {
+                worker_main(&workers[t]);
+                _exit(EXIT_SUCCESS);
+            }
+            if (workers[t].pid > 0) {
+                continue;
+            }
+            perror("fork");
+        } else if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) == 0) {
+            continue;
+        } else {
+            perror("pthread_create");
+        }
+        sh->running = 0;
+        threads = t;
+        break;
+    }
+    sleep(seconds);
+    sh->running = 0;
+    for (t = 0; t < threads; t++) {
+        if (use_procs) {
+            waitpid(workers[t].pid, NULL, 0);
+        } else {
+            pthread_join(workers[t].thread, NULL);
+        }
+    }
+    t1 = now_ns();
+    elapsed = (t1 - t0) / 1e9;
+
+    /* Merge and report */
+    memset(total, 0, sizeof(total));
+    for (t = 0; t < threads; t++) {
+        for (i = 0; i < OP_COUNT; i++) {
+            hist_merge(&total[i], &workers[t].hist[i]);
+        }
+        printf("worker %2u: %llu writes\n", t,
+               (unsigned long long) workers[t].hist[OP_WRITE].count);
+    }
+    for (i = 0; i < OP_COUNT; i++) {
+        if (i == OP_READ && !read_back) {
+            continue;
+        }
+        hist_print(op_name[i], &total[i], elapsed);
+    }
+
+    /* All LEDs off */
+    for (t = 0; t < threads; t++) {
+        for (i = 0; i < num_leds; i++) {
+            if (t == 0) {
+                write(workers[t].fd[i], "off", 3);
+            }
+            close(workers[t].fd[i]);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,168 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Play a moving light in led_driver_quad without userspace timing
+ *
+ *          Uploads a moving light pattern (one frame per LED and step)
+ *          to the in-kernel pattern engine and prints its progress and
+ *          the timer lateness once per second until the pattern ends.
+ *          CTRL-C stops the pattern.
+ *
+ *          Usage: led_pattern [-t step_us] [-l loops] [-b] [-s] [-d devdir]
+ *                 -b  bounce back and forth instead of wrapping around
+ *                 -s  only stop a running pattern
+ *
+ * \file    led_pattern.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define DEF_STEP_US		100000
+#define MAX_LEDS		64
+#define MAX_PATH_STR		256
+
+static volatile sig_atomic_t running = 1;
+
+/*
+ ***************************************************************************
+ * Stop on CTRL-C
+ ***************************************************************************
+ */
+static void signal_callback_handler(int signum)
+{
+    (void) signum;
+    running = 0;
+}
+
+/*
+ ***************************************************************************
+ * Print the pattern status
+ ***************************************************************************
+ */
+static void print_status(const struct led_pattern_status *st)
+{
+    printf("%s  loop %u frame %u  shown %llu  late %u  "
+           "err last %lld ns mean %.0f ns max %lld ns\n",
+           st->running ? "running" : "stopped", st->loop, st->frame,
+           (unsigned long long) st->frames_shown, st->late_frames,
+           (long long) st->err_last_ns,
+           st->frames_shown ? (double) st->err_sum_ns / st->frames_shown : 0.0,
+           (long long) st->err_max_ns);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    const char *dev_dir = "/dev";
+    struct led_frame frames[2 * MAX_LEDS];
+    struct led_pattern pat;
+    struct led_pattern_status st;
+    unsigned step_us = DEF_STEP_US, loops = 0, count = 0, n = 0, i;
+    int bounce = 0, stop_only = 0, fd, opt;
+
+    while ((opt = getopt(argc, argv, "t:l:bsd:")) != -1) {
+        switch (opt) {
+        case 't':
+            step_us = atoi(optarg);
+            break;
+        case 'l':
+            loops = atoi(optarg);
+            break;
+        case 'b':
+            bounce = 1;
+            break;
+        case 's':
+            stop_only = 1;
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-t step_us] [-l loops] [-b] [-s] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", dev_dir, LED_AGGR_NODE_NAME);
+    if ((fd = open(path, O_RDWR)) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    if (stop_only) {
+        ioctl(fd, LED_IOC_PATTERN_STOP);
+        close(fd);
+        return EXIT_SUCCESS;
+    }
+    if (ioctl(fd, LED_IOC_GET_COUNT, &count) < 0 || count == 0 || count > MAX_LEDS) {
+        perror("LED_IOC_GET_COUNT");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    /* One frame per LED, on the way back without the two ends */
+    for (i = 0; i < count; i++) {
+        frames[n].mask        = 1ULL << i;
+        frames[n].duration_us = step_us;
+        frames[n++].reserved  = 0;
+    }
+    for (i = count - 1; bounce && i > 1; i--) {
+        frames[n].mask        = 1ULL << (i - 1);
+        frames[n].duration_us = step_us;
+        frames[n++].reserved  = 0;
+    }
+
+    pat.count  = n;
+    pat.loops  = loops;
+    pat.frames = (uintptr_t) frames;
+    if (ioctl(fd, LED_IOC_PATTERN_START, &pat) < 0) {
+        perror("LED_IOC_PATTERN_START");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, signal_callback_handler);
+    do {
+        sleep(1);
+        if (ioctl(fd, LED_IOC_PATTERN_STATUS, &st) < 0) {
+            perror("LED_IOC_PATTERN_STATUS");
+            break;
+        }
+        print_status(&st);
+    } while (running && st.running);
+
+    if (!running) {
+        ioctl(fd, LED_IOC_PATTERN_STOP);
+    }
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Dim LEDs with the software PWM of led_driver_quad
+ *
+ *          Sets the duty of one LED (or all with -a) and prints the PWM
+ *          statistics once per second: edges per second, CPU share of
+ *          the PWM timer and the edge jitter. With -b the duty breathes
+ *          between 0 and the given value. CTRL-C turns the PWM off.
+ *
+ *          Usage: led_pwm [-l led | -a] [-p duty_permille] [-f freq_hz]
+ *                         [-b] [-d devdir]
+ *
+ * \file    led_pwm.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define DEF_DUTY		100
+#define BREATHE_STEP_MS		20
+#define BREATHE_STEPS		50
+#define MAX_PATH_STR		256
+
+static volatile sig_atomic_t running = 1;
+
+/*
+ ***************************************************************************
+ * Stop on CTRL-C
+ ***************************************************************************
+ */
+static void signal_callback_handler(int signum)
+{
+    (void) signum;
+    running = 0;
+}
+
+/*
+ ***************************************************************************
+ * Print the PWM statistics, rates over the last interval
+ ***************************************************************************
+ */
+static void print_stats(const struct led_pwm_stats *st, const struct led_pwm_stats *last)
+{
+    uint64_t dt    = st->elapsed_ns - last->elapsed_ns;
+    uint64_t edges = st->edges - last->edges;
+
+    if (dt == 0 || st->elapsed_ns < last->elapsed_ns) {
+        return;
+    }
+    printf("%u Hz, %u LEDs: %6.0f edges/s, cpu %5.2f %%, "
+           "cpu max %llu ns, jitter mean %llu ns max %lld ns\n",
+           st->freq_hz, st->channels, edges * 1e9 / dt,
+           100.0 * (st->cpu_ns - last->cpu_ns) / dt,
+           (unsigned long long) st->cpu_max_ns,
+           (unsigned long long) (edges ? (st->late_sum_ns - last->late_sum_ns) / edges : 0),
+           (long long) st->late_max_ns);
+    fflush(stdout);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    const char *dev_dir = "/dev";
+    struct led_pwm_stats st, last = { 0 };
+    struct timespec step = { 0, BREATHE_STEP_MS * 1000000L };
+    uint32_t duty = DEF_DUTY, freq = 0, d, off = 0;
+    int led = 0, all = 0, breathe = 0, n = 0, fd, opt;
+
+    while ((opt = getopt(argc, argv, "l:ap:f:bd:")) != -1) {
+        switch (opt) {
+        case 'l':
+            led = atoi(optarg);
+            break;
+        case 'a':
+            all = 1;
+            break;
+        case 'p':
+            duty = atoi(optarg);
+            break;
+        case 'f':
+            freq = atoi(optarg);
+            break;
+        case 'b':
+            breathe = 1;
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-l led | -a] [-p duty_permille] [-f freq_hz] "
+                    "[-b] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (all) {
+        snprintf(path, sizeof(path), "%s/%s", dev_dir, LED_AGGR_NODE_NAME);
+    } else {
+        snprintf(path, sizeof(path), "%s/led%d", dev_dir, led);
+    }
+    if ((fd = open(path, O_RDWR)) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    if (freq && ioctl(fd, LED_IOC_PWM_SET_FREQ, &freq) < 0) {
+        perror("LED_IOC_PWM_SET_FREQ");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    if (ioctl(fd, LED_IOC_PWM_SET_DUTY, &duty) < 0) {
+        perror("LED_IOC_PWM_SET_DUTY");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, signal_callback_handler);
+    while (running) {
+        if (breathe) {
+            /* Triangle from 0 to duty and back, one step per BREATHE_STEP_MS */
+            d = n % (2 * BREATHE_STEPS);
+            d = (d < BREATHE_STEPS ? d : 2 * BREATHE_STEPS - d) * duty / BREATHE_STEPS;
+            d = d ? d : 1;
+            ioctl(fd, LED_IOC_PWM_SET_DUTY, &d);
+            nanosleep(&step, NULL);
+            if (++n % (1000 / BREATHE_STEP_MS) != 0) {
+                continue;
+            }
+        } else {
+            sleep(1);
+        }
+        if (ioctl(fd, LED_IOC_PWM_STATS, &st) == 0) {
+            print_stats(&st, &last);
+            last = st;
+        }
+    }
+
+    /* Back to on/off control, LED off */
+    ioctl(fd, LED_IOC_PWM_SET_DUTY, &off);
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Schedule LED commands at absolute deadlines and verify them
+ *
+ *          Queues n commands that toggle LED 0 every period_us, starting
+ *          start_ms from now, on the deadline queue of led_driver_quad.
+ *          After the last deadline the results are fetched and the
+ *          lateness distribution is printed. No thread of this program
+ *          is awake at the deadlines.
+ *
+ *          Usage: led_sched [-n commands] [-p period_us] [-s start_ms]
+ *                           [-d devdir]
+ *
+ * \file    led_sched.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define DEF_COMMANDS		LED_QUEUE_DEPTH
+#define DEF_PERIOD_US		10000
+#define DEF_START_MS		100
+#define MAX_PATH_STR		256
+
+/*
+ ***************************************************************************
+ * Monotonic time in ns, same clock as the driver deadlines
+ ***************************************************************************
+ */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ ***************************************************************************
+ * Sort helper for the lateness values
+ ***************************************************************************
+ */
+static int cmp_s64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *) a, y = *(const int64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    const char *dev_dir = "/dev";
+    struct led_timed_cmd cmd;
+    struct led_queue_result res;
+    struct led_queue_stats stats;
+    struct timespec wait;
+    unsigned commands = DEF_COMMANDS, period_us = DEF_PERIOD_US;
+    unsigned start_ms = DEF_START_MS, got = 0, i;
+    int64_t *late, sum = 0;
+    uint64_t t0;
+    int fd, opt;
+
+    while ((opt = getopt(argc, argv, "n:p:s:d:")) != -1) {
+        switch (opt) {
+        case 'n':
+            commands = atoi(optarg);
+            break;
+        case 'p':
+            period_us = atoi(optarg);
+            break;
+        case 's':
+            start_ms = atoi(optarg);
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-n commands] [-p period_us] [-s start_ms] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (commands == 0 || commands > LED_QUEUE_DEPTH) {
+        fprintf(stderr, "commands must be 1..%d\n", LED_QUEUE_DEPTH);
+        return EXIT_FAILURE;
+    }
+    if ((late = calloc(commands, sizeof(*late))) == NULL) {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", dev_dir, LED_AGGR_NODE_NAME);
+    if ((fd = open(path, O_RDWR)) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+
+    /* Drop old commands and results */
+    ioctl(fd, LED_IOC_QUEUE_FLUSH);
+    while (ioctl(fd, LED_IOC_QUEUE_RESULT, &res) == 0) {
+        ;
+    }
+
+    /* Queue the toggles of LED 0 */
+    t0 = now_ns() + (uint64_t) start_ms * 1000000ULL;
+    for (i = 0; i < commands; i++) {
+        cmd.deadline_ns = t0 + (uint64_t) i * period_us * 1000ULL;
+        cmd.mask        = 1;
+        cmd.value       = (i & 1) ? 0 : 1;
+        cmd.id          = i;
+        cmd.reserved    = 0;
+        if (ioctl(fd, LED_IOC_QUEUE_ADD, &cmd) < 0) {
+            perror("LED_IOC_QUEUE_ADD");
+            close(fd);
+            return EXIT_FAILURE;
+        }
+    }
+
+    /* Sleep past the last deadline */
+    wait.tv_sec  = (start_ms / 1000) + ((uint64_t) commands * period_us) / 1000000 + 1;
+    wait.tv_nsec = 0;
+    nanosleep(&wait, NULL);
+
+    while (got < commands && ioctl(fd, LED_IOC_QUEUE_RESULT, &res) == 0) {
+        late[got++] = res.late_ns;
+        sum += res.late_ns;
+    }
+    if (ioctl(fd, LED_IOC_QUEUE_STATS, &stats) < 0) {
+        perror("LED_IOC_QUEUE_STATS");
+        stats.pending = 0;
+    }
+    close(fd);
+
+    if (got == 0) {
+        printf("No results\n");
+        return EXIT_FAILURE;
+    }
+    qsort(late, got, sizeof(*late), cmp_s64);
+    printf("%u of %u commands executed, %u still pending\n", got, commands, stats.pending);
+    printf("lateness: min %lld ns  mean %lld ns  p50 %lld ns  p99 %lld ns  max %lld ns\n",
+           (long long) late[0], (long long) (sum / got), (long long) late[got / 2],
+           (long long) late[(got * 99) / 100], (long long) late[got - 1]);
+
+    free(late);
+    return EXIT_SUCCESS;
+}
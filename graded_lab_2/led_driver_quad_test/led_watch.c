@@ -0,0 +1,210 @@
+/*
+ ***************************************************************************
+ * \brief   Embedded-Linux (BTE5446)
+ *          Watch the LED state through the mmap-ed status page
+ *
+ *          Maps the read-only status page of led_driver_quad and prints
+ *          every change of the LED mask. Reading the page costs no
+ *          syscall, only the sleep between two polls does.
+ *
+ *          With -e the watcher instead sleeps in poll() until the driver
+ *          reports a change and reads it as a struct led_event, so every
+ *          change is seen without polling at a fixed interval.
+ *
+ *          Usage: led_watch [-e] [-i interval_ms] [-d devdir]
+ *
+ * \file    led_watch.c
+ * \version 1.0
+ * \date    18.10.2026
+ * \author  Aaron Schmocker
+ *
+ * \remark  Last Modifications:
+ * \remark  V1.0, SCHMA5, 18.10.2026   Initial release
+ * \remark  V1.1, SCHMA5, 18.10.2026   Event mode with poll()
+ ***************************************************************************
+ *
+ * Copyright (C) 2015 Martin Aebersold, Bern University of Applied Scinces
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <errno.h>
+
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+
+#include "led_driver_quad.h"
+
+/* Define some useful constants */
+#define DEF_INTERVAL_MS		10
+#define MAX_PATH_STR		256
+
+static volatile sig_atomic_t running = 1;
+
+/*
+ ***************************************************************************
+ * Stop on CTRL-C
+ ***************************************************************************
+ */
+static void signal_callback_handler(int signum)
+{
+    (void) signum;
+    running = 0;
+}
+
+/*
+ ***************************************************************************
+ * Print one snapshot, LED 0 rightmost
+ ***************************************************************************
+ */
+static void print_state(const struct led_status_page *snap)
+{
+    int i;
+
+    printf("%llu.%09llu  changes %-8llu  ",
+           (unsigned long long) (snap->changed_ns / 1000000000ULL),
+           (unsigned long long) (snap->changed_ns % 1000000000ULL),
+           (unsigned long long) snap->changes);
+    for (i = snap->count - 1; i >= 0; i--) {
+        putchar((snap->mask >> i) & 1 ? '*' : '.');
+    }
+    putchar('\n');
+    fflush(stdout);
+}
+
+/*
+ ***************************************************************************
+ * Event mode: sleep in poll() and read one event per change
+ ***************************************************************************
+ */
+static int watch_events(int fd, unsigned count)
+{
+    struct led_status_page snap;
+    struct led_event ev;
+    struct pollfd pfd;
+    uint32_t on = 1, last_seq = 0;
+
+    if (ioctl(fd, LED_IOC_EVENTS, &on) < 0) {
+        perror("LED_IOC_EVENTS");
+        return -1;
+    }
+    pfd.fd     = fd;
+    pfd.events = POLLIN;
+
+    while (running) {
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll");
+            return -1;
+        }
+        if (read(fd, &ev, sizeof(ev)) != sizeof(ev)) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("read");
+            return -1;
+        }
+        if (last_seq != 0 && ev.seq != last_seq + 1) {
+            printf("(%u changes missed)\n", ev.seq - last_seq - 1);
+        }
+        last_seq = ev.seq;
+
+        snap.count      = count;
+        snap.mask       = ev.mask;
+        snap.changed_ns = ev.changed_ns;
+        snap.changes    = ev.seq;
+        print_state(&snap);
+    }
+    return 0;
+}
+
+/*
+ ***************************************************************************
+ * main
+ ***************************************************************************
+ */
+int main(int argc, char *argv[])
+{
+    char path[MAX_PATH_STR];
+    const char *dev_dir = "/dev";
+    const volatile struct led_status_page *page;
+    struct led_status_page snap;
+    struct timespec interval;
+    unsigned interval_ms = DEF_INTERVAL_MS;
+    uint32_t last_seq;
+    int events = 0, fd, opt, ret;
+
+    while ((opt = getopt(argc, argv, "ei:d:")) != -1) {
+        switch (opt) {
+        case 'e':
+            events = 1;
+            break;
+        case 'i':
+            interval_ms = atoi(optarg);
+            break;
+        case 'd':
+            dev_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-e] [-i interval_ms] [-d devdir]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", dev_dir, LED_AGGR_NODE_NAME);
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    page = mmap(NULL, sizeof(*page), PROT_READ, MAP_SHARED, fd, 0);
+    if (page == MAP_FAILED) {
+        perror("mmap");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    signal(SIGINT, signal_callback_handler);
+
+    if (events) {
+        led_status_read(page, &snap);
+        ret = watch_events(fd, snap.count);
+        munmap((void *) page, sizeof(*page));
+        close(fd);
+        return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    /* The mapping stays valid without the file descriptor */
+    close(fd);
+
+    interval.tv_sec  = interval_ms / 1000;
+    interval.tv_nsec = (long) (interval_ms % 1000) * 1000000;
+
+    led_status_read(page, &snap);
+    print_state(&snap);
+    last_seq = snap.seq;
+
+    while (running) {
+        nanosleep(&interval, NULL);
+        led_status_read(page, &snap);
+        if (snap.seq != last_seq) {
+            print_state(&snap);
+            last_seq = snap.seq;
+        }
+    }
+
+    munmap((void *) page, sizeof(*page));
+    return EXIT_SUCCESS;
+}